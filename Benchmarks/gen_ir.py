@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+"""Generates synthetic LLVM IR modules for benchmarking alias_lib and cons_eval.
+
+The IR mimics clang -O0 output (every variable lives in an alloca, values go
+through loads and stores), which is what both passes are written for.
+Everything is derived from the seed, so a configuration always produces the
+same module.
+"""
+
+import argparse
+import random
+import sys
+
+
+class FunctionWriter:
+    def __init__(self, rng, args, index, callee):
+        self.rng = rng
+        self.args = args
+        self.index = index
+        self.callee = callee
+        self.lines = []
+        self.temp = 0
+
+    def emit(self, line):
+        self.lines.append("  " + line)
+
+    def label(self, name):
+        self.lines.append(name + ":")
+
+    def fresh(self):
+        self.temp += 1
+        return "%t" + str(self.temp)
+
+    def pick(self, count):
+        return self.rng.randrange(count)
+
+    def pointer_statement(self):
+        p, q = self.args.pointers, max(1, self.args.pointers // 4)
+        r = self.rng.random()
+        if r < 0.35:  # p = &v
+            self.emit(f"store i32* %v{self.pick(p)}, i32** %p{self.pick(p)}, align 8")
+        elif r < 0.6:  # p = q
+            t = self.fresh()
+            self.emit(f"{t} = load i32*, i32** %p{self.pick(p)}, align 8")
+            self.emit(f"store i32* {t}, i32** %p{self.pick(p)}, align 8")
+        elif r < 0.75:  # pp = &p
+            self.emit(f"store i32** %p{self.pick(p)}, i32*** %pp{self.pick(q)}, align 8")
+        elif r < 0.88:  # p = *pp
+            t1, t2 = self.fresh(), self.fresh()
+            self.emit(f"{t1} = load i32**, i32*** %pp{self.pick(q)}, align 8")
+            self.emit(f"{t2} = load i32*, i32** {t1}, align 8")
+            self.emit(f"store i32* {t2}, i32** %p{self.pick(p)}, align 8")
+        else:  # *pp = p
+            t1, t2 = self.fresh(), self.fresh()
+            self.emit(f"{t1} = load i32*, i32** %p{self.pick(p)}, align 8")
+            self.emit(f"{t2} = load i32**, i32*** %pp{self.pick(q)}, align 8")
+            self.emit(f"store i32* {t1}, i32** {t2}, align 8")
+
+    def integer_statement(self):
+        t1, t2 = self.fresh(), self.fresh()
+        op = self.rng.choice(["add", "sub", "mul"])
+        self.emit(f"{t1} = load i32, i32* %v{self.pick(self.args.pointers)}, align 4")
+        self.emit(f"{t2} = {op} nsw i32 {t1}, {self.rng.randrange(1, 10)}")
+        self.emit(f"store i32 {t2}, i32* %v{self.pick(self.args.pointers)}, align 4")
+
+    def call_statement(self):
+        t1, t2 = self.fresh(), self.fresh()
+        self.emit(f"{t1} = load i32, i32* %x.addr, align 4")
+        self.emit(f"{t2} = call i32 @f{self.callee}(i32 noundef {t1}, i32 noundef {self.rng.randrange(10)})")
+        self.emit(f"store i32 {t2}, i32* %v{self.pick(self.args.pointers)}, align 4")
+
+    def body_block(self, b):
+        self.label(f"body{b}")
+        for _ in range(self.args.statements):
+            if self.rng.random() < self.args.store_density:
+                self.pointer_statement()
+            else:
+                self.integer_statement()
+        if b == 0 and self.callee is not None:
+            self.call_statement()
+        if b == self.args.blocks - 1:
+            self.emit(f"br label %latch{self.args.loop_depth - 1}" if self.args.loop_depth else "br label %exit")
+            return
+        t1, t2 = self.fresh(), self.fresh()
+        self.emit(f"{t1} = load i32, i32* %v{self.pick(self.args.pointers)}, align 4")
+        self.emit(f"{t2} = icmp ne i32 {t1}, 0")
+        self.emit(f"br i1 {t2}, label %body{b + 1}, label %body{self.rng.randrange(b + 1)}")
+
+    def write(self):
+        a = self.args
+        self.lines.append(f"define dso_local i32 @f{self.index}(i32 noundef %x, i32 noundef %y) {{")
+        self.label("entry")
+        self.emit("%x.addr = alloca i32, align 4")
+        self.emit("%y.addr = alloca i32, align 4")
+        for k in range(a.pointers):
+            self.emit(f"%v{k} = alloca i32, align 4")
+        for k in range(a.pointers):
+            self.emit(f"%p{k} = alloca i32*, align 8")
+        for k in range(max(1, a.pointers // 4)):
+            self.emit(f"%pp{k} = alloca i32**, align 8")
+        for d in range(a.loop_depth):
+            self.emit(f"%i{d} = alloca i32, align 4")
+        self.emit("store i32 %x, i32* %x.addr, align 4")
+        self.emit("store i32 %y, i32* %y.addr, align 4")
+        for k in range(a.pointers):
+            self.emit(f"store i32 {k}, i32* %v{k}, align 4")
+        if a.loop_depth:
+            self.emit("store i32 0, i32* %i0, align 4")
+        self.emit("br label %" + ("header0" if a.loop_depth else "body0"))
+
+        for d in range(a.loop_depth):  # Loop headers, outermost first
+            self.label(f"header{d}")
+            if d + 1 < a.loop_depth:
+                self.emit(f"store i32 0, i32* %i{d + 1}, align 4")
+            t1, t2 = self.fresh(), self.fresh()
+            self.emit(f"{t1} = load i32, i32* %i{d}, align 4")
+            self.emit(f"{t2} = icmp slt i32 {t1}, 10")
+            outer = f"latch{d - 1}" if d else "exit"
+            inner = f"header{d + 1}" if d + 1 < a.loop_depth else "body0"
+            self.emit(f"br i1 {t2}, label %{inner}, label %{outer}")
+
+        for b in range(a.blocks):
+            self.body_block(b)
+
+        for d in reversed(range(a.loop_depth)):  # Loop latches, innermost first
+            self.label(f"latch{d}")
+            t1, t2 = self.fresh(), self.fresh()
+            self.emit(f"{t1} = load i32, i32* %i{d}, align 4")
+            self.emit(f"{t2} = add nsw i32 {t1}, 1")
+            self.emit(f"store i32 {t2}, i32* %i{d}, align 4")
+            self.emit(f"br label %header{d}")
+
+        self.label("exit")
+        t = self.fresh()
+        self.emit(f"{t} = load i32, i32* %v0, align 4")
+        self.emit(f"ret i32 {t}")
+        self.lines.append("}")
+        return "\n".join(self.lines)
+
+
+def generate(args):
+    rng = random.Random(args.seed)
+    out = [f"; Generated by gen_ir.py {' '.join(sys.argv[1:])}", ""]
+    depth = max(1, args.call_depth)
+
+    for k in range(args.functions):  # Functions form call chains of length call_depth: f0 -> f1 -> ... -> f(depth-1), then f(depth) -> ...
+        callee = k + 1 if (k + 1) % depth != 0 and k + 1 < args.functions else None
+        out.append(FunctionWriter(rng, args, k, callee).write())
+        out.append("")
+
+    out.append("define dso_local i32 @main() {")
+    out.append("entry:")
+    for k in range(0, args.functions, depth):
+        out.append(f"  %call{k} = call i32 @f{k}(i32 noundef {k}, i32 noundef 1)")
+    out.append("  ret i32 0")
+    out.append("}")
+    return "\n".join(out) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--functions", type=int, default=4, help="number of functions besides main")
+    parser.add_argument("--blocks", type=int, default=8, help="number of body basic blocks per function")
+    parser.add_argument("--loop-depth", type=int, default=1, help="number of loops nested around the body of each function")
+    parser.add_argument("--pointers", type=int, default=16, help="number of pointer variables (and of int variables) per function")
+    parser.add_argument("--call-depth", type=int, default=2, help="length of the call chains between the functions")
+    parser.add_argument("--statements", type=int, default=20, help="number of statements per body block")
+    parser.add_argument("--store-density", type=float, default=0.5, help="fraction of statements which are pointer assignments")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("-o", "--output", default="-", help="output file ('-' for the standard output)")
+    args = parser.parse_args()
+
+    if args.functions < 1 or args.blocks < 1 or args.pointers < 1:
+        parser.error("--functions, --blocks and --pointers must be positive")
+
+    text = generate(args)
+
+    if args.output == "-":
+        sys.stdout.write(text)
+    else:
+        with open(args.output, "w") as f:
+            f.write(text)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+"""Times alias_lib_given and cons_eval_given on generated IR of increasing size.
+
+Each knob of gen_ir.py is swept in turn around a base configuration. For every
+pass and configuration one JSON object is printed per line, with the wall time
+(median over --repeat runs), the peak RSS of opt and the fixpoint counters
+reported by the pass, so that results can be collected and compared over time.
+"""
+
+import argparse
+import datetime
+import json
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+BASE = {"functions": 4, "blocks": 8, "loop_depth": 1, "pointers": 16, "call_depth": 2, "statements": 20, "store_density": 0.5}
+
+SUITES = {
+    "quick": {
+        "functions": [1, 4, 16],
+        "blocks": [4, 16],
+        "pointers": [8, 32],
+    },
+    "full": {
+        "functions": [1, 4, 16, 64],
+        "blocks": [4, 16, 64],
+        "loop_depth": [0, 1, 2, 4],
+        "pointers": [8, 32, 128],
+        "call_depth": [1, 2, 4, 8],
+        "store_density": [0.1, 0.5, 0.9],
+    },
+}
+
+
+def configurations(suite):
+    yield dict(BASE)
+    for knob, sizes in SUITES[suite].items():
+        for size in sizes:
+            if size != BASE[knob]:
+                config = dict(BASE)
+                config[knob] = size
+                yield config
+
+
+def generate(config, path, seed):
+    command = [sys.executable, os.path.join(HERE, "gen_ir.py"), "--seed", str(seed), "-o", path]
+    for knob, value in config.items():
+        command += ["--" + knob.replace("_", "-"), str(value)]
+    subprocess.run(command, check=True)
+
+
+def run_once(command):
+    """Runs the command, returning its wall time, peak RSS in KiB and standard error."""
+    with tempfile.TemporaryFile() as stderr:
+        start = time.perf_counter()
+        process = subprocess.Popen(command, stdout=subprocess.DEVNULL, stderr=stderr)
+        _, status, usage = os.wait4(process.pid, 0)
+        seconds = time.perf_counter() - start
+        process.returncode = os.waitstatus_to_exitcode(status)  # Reaped by wait4 rather than by Popen, which needs the status for its cleanup
+        stderr.seek(0)
+        errors = stderr.read().decode(errors="replace")
+    if process.returncode != 0:
+        raise RuntimeError(f"{' '.join(command)} failed with status {process.returncode}:\n{errors}")
+    return seconds, usage.ru_maxrss, errors
+
+
+def work_counters(errors, pass_name):
+    """Returns the counters printed by the pass with -alias-print-work or -cons-print-work."""
+    for line in reversed(errors.splitlines()):
+        if line.startswith("{"):
+            try:
+                counters = json.loads(line)
+            except ValueError:
+                continue
+            if counters.get("pass") == pass_name:
+                del counters["pass"]
+                return counters
+    return {}
+
+
+def git_revision():
+    try:
+        return subprocess.run(["git", "-C", HERE, "rev-parse", "--short", "HEAD"], capture_output=True, text=True, check=True).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--alias-lib", help="shared library built from May_Alias_Analysis/alias_lib.cpp")
+    parser.add_argument("--cons-lib", help="shared library built from Inter-Procedural_Constant_Propagation/cons_eval.cpp")
+    parser.add_argument("--opt", default="opt", help="opt binary to load the passes into")
+    parser.add_argument("--suite", choices=sorted(SUITES), default="quick")
+    parser.add_argument("--repeat", type=int, default=3, help="runs per pass and configuration; the median time is reported")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--extra-args", default="", help="additional opt arguments, e.g. -alias-mode=andersen")
+    parser.add_argument("-o", "--output", default="-", help="file to append the results to ('-' for the standard output)")
+    args = parser.parse_args()
+
+    if not args.alias_lib and not args.cons_lib:
+        parser.error("at least one of --alias-lib and --cons-lib is required")
+
+    output = sys.stdout if args.output == "-" else open(args.output, "a")
+    revision = git_revision()
+    timestamp = datetime.datetime.now(datetime.timezone.utc).isoformat(timespec="seconds")
+
+    with tempfile.TemporaryDirectory() as directory:
+        ir_path = os.path.join(directory, "bench.ll")
+        passes = []
+
+        if args.alias_lib:
+            passes.append(("alias_lib_given", [args.opt, "-enable-new-pm=0", "-load", os.path.abspath(args.alias_lib), "-alias_lib_given",
+                                               "-alias-print-work", "-alias-echo=false", "-alias-output=" + os.path.join(directory, "report.txt")]))
+        if args.cons_lib:
+            passes.append(("cons_eval_given", [args.opt, "-enable-new-pm=0", "-load", os.path.abspath(args.cons_lib), "-cons_eval_given",
+                                               "-cons-print-work"]))
+
+        for config in configurations(args.suite):
+            generate(config, ir_path, args.seed)
+
+            with open(ir_path) as f:
+                instructions = sum(1 for line in f if line.startswith("  "))
+
+            for pass_name, command in passes:
+                command = command + args.extra_args.split() + ["-disable-output", ir_path]
+                times, peak_rss = [], 0
+
+                for _ in range(max(1, args.repeat)):
+                    seconds, rss, errors = run_once(command)
+                    times.append(seconds)
+                    peak_rss = max(peak_rss, rss)
+
+                result = {"pass": pass_name, "config": config, "instructions": instructions, "seconds": round(statistics.median(times), 6),
+                          "peak_rss_kb": peak_rss}
+                result.update(work_counters(errors, pass_name))
+                result.update({"revision": revision, "timestamp": timestamp})
+
+                output.write(json.dumps(result) + "\n")
+                output.flush()
+
+    if output is not sys.stdout:
+        output.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,182 @@
+#ifndef FIXPOINT_TRACE_H
+#define FIXPOINT_TRACE_H
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/PassTimingInfo.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The work done by a dataflow fixpoint computation
+struct fixpoint_counters
+{
+  uint64_t worklist_pops = 0;
+  uint64_t transfers = 0;  // Transfer function evaluations
+  uint64_t meets = 0;
+  uint64_t lattice_size = 0; // Size of the dataflow facts at convergence
+
+  fixpoint_counters &operator+=(const fixpoint_counters &other)
+  {
+    worklist_pops += other.worklist_pops;
+    transfers += other.transfers;
+    meets += other.meets;
+    lattice_size += other.lattice_size;
+
+    return *this;
+  }
+};
+
+// Collects one event per analyzed function, and writes them as a Chrome trace (for chrome://tracing or Perfetto) showing which functions dominate
+// Events may be added from several threads; each thread gets its own track
+class fixpoint_trace
+{
+public:
+  typedef std::chrono::steady_clock clock;
+
+  // The trace is disabled if the path is empty
+  // concurrent is set if the functions are analyzed on several threads at once, which LLVM's timers do not support
+  explicit fixpoint_trace(const std::string &path, bool concurrent = false) : path(path), epoch(clock::now()), concurrent(concurrent) {}
+
+  bool enabled() const
+  {
+    return !path.empty();
+  }
+
+  bool isConcurrent() const
+  {
+    return concurrent;
+  }
+
+  void add(llvm::StringRef pass_name, llvm::StringRef function_name, clock::time_point start, clock::time_point end, const fixpoint_counters &counters)
+  {
+    if (!enabled())
+    {
+      return;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    event e;
+
+    e.pass_name = pass_name.str();
+    e.function_name = function_name.str();
+    e.start = std::chrono::duration_cast<std::chrono::microseconds>(start - epoch).count();
+    e.duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    e.thread = getThreadNumber();
+    e.counters = counters;
+
+    events.push_back(e);
+  }
+
+  // Writes {"traceEvents": [...]} to the path of the trace
+  void write()
+  {
+    std::error_code EC;
+
+    if (!enabled())
+    {
+      return;
+    }
+
+    llvm::raw_fd_ostream output_file(path, EC, llvm::sys::fs::OF_Text);
+
+    if (EC)
+    {
+      llvm::errs() << "cannot open " << path << ": " << EC.message() << "\n";
+      return;
+    }
+
+    llvm::json::OStream J(output_file);
+
+    J.object([&] {
+      J.attributeArray("traceEvents", [&] {
+        for (const event &e : events)
+        {
+          J.object([&] {
+            J.attribute("name", e.function_name);
+            J.attribute("cat", e.pass_name);
+            J.attribute("ph", "X");
+            J.attribute("pid", 1);
+            J.attribute("tid", (int64_t)e.thread);
+            J.attribute("ts", e.start);
+            J.attribute("dur", e.duration);
+            J.attributeObject("args", [&] {
+              J.attribute("worklist_pops", (int64_t)e.counters.worklist_pops);
+              J.attribute("transfers", (int64_t)e.counters.transfers);
+              J.attribute("meets", (int64_t)e.counters.meets);
+              J.attribute("lattice_size", (int64_t)e.counters.lattice_size);
+            });
+          });
+        }
+      });
+      J.attribute("displayTimeUnit", "ms");
+    });
+  }
+
+private:
+  struct event
+  {
+    std::string pass_name, function_name;
+    int64_t start, duration;  // In microseconds since the trace was created
+    unsigned thread;
+    fixpoint_counters counters;
+  };
+
+  std::string path;
+  clock::time_point epoch;
+  bool concurrent;
+  std::mutex lock;
+  std::vector<event> events;
+  std::vector<std::thread::id> threads; // Thread number -> thread
+
+  unsigned getThreadNumber()
+  {
+    for (unsigned i = 0; i < threads.size(); i++)
+    {
+      if (threads[i] == std::this_thread::get_id())
+      {
+        return i;
+      }
+    }
+
+    threads.push_back(std::this_thread::get_id());
+
+    return threads.size() - 1;
+  }
+};
+
+// Measures the analysis of one function from construction to destruction
+// The time is reported per function under -time-passes, and an event with the counters (read at destruction) is added to the trace
+// The named timers of -time-passes are not thread-safe, so the functions of a concurrent trace are only timed in the trace
+class function_timer
+{
+public:
+  function_timer(fixpoint_trace &trace, llvm::StringRef pass_name, llvm::Function &F, const fixpoint_counters &counters)
+      : timer(F.getName(), F.getName(), pass_name, pass_name.str() + " time per function", llvm::TimePassesIsEnabled && !trace.isConcurrent()), trace(trace),
+        pass_name(pass_name), function_name(F.getName()), counters(counters), start(fixpoint_trace::clock::now())
+  {
+  }
+
+  ~function_timer()
+  {
+    trace.add(pass_name, function_name, start, fixpoint_trace::clock::now(), counters);
+  }
+
+private:
+  llvm::NamedRegionTimer timer;
+  fixpoint_trace &trace;
+  llvm::StringRef pass_name, function_name;
+  const fixpoint_counters &counters;
+  fixpoint_trace::clock::time_point start;
+};
+
+#endif
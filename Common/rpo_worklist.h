@@ -0,0 +1,90 @@
+#ifndef RPO_WORKLIST_H
+#define RPO_WORKLIST_H
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/PostOrderIterator.h"
+
+#include <functional>
+#include <queue>
+#include <vector>
+
+// Worklist of basic blocks which always pops the pending basic block that comes first in reverse postorder
+// Blocks which are unreachable from the entry block are ordered after the reachable ones, in layout order
+// Since the order depends only on the CFG, the sequence of pops (and hence the number of iterations) is the same on every run
+class rpo_worklist
+{
+public:
+  explicit rpo_worklist(llvm::Function &F)
+  {
+    for (llvm::BasicBlock *BB : llvm::ReversePostOrderTraversal<llvm::Function *>(&F))
+    {
+      rpo_numbers[BB] = blocks.size();
+      blocks.push_back(BB);
+    }
+
+    for (llvm::BasicBlock &BB : F)  // Appending the unreachable basic blocks
+    {
+      if (rpo_numbers.find(&BB) == rpo_numbers.end())
+      {
+        rpo_numbers[&BB] = blocks.size();
+        blocks.push_back(&BB);
+      }
+    }
+
+    pending.resize(blocks.size());
+  }
+
+  // Adds the basic block to the worklist, if it is not already pending
+  void push(llvm::BasicBlock *BB)
+  {
+    int rpo_number = rpo_numbers[BB];
+
+    if (!pending.test(rpo_number))
+    {
+      pending.set(rpo_number);
+      queue.push(rpo_number);
+    }
+  }
+
+  // Adds all the basic blocks of the function to the worklist
+  void pushAll()
+  {
+    for (llvm::BasicBlock *BB : blocks)
+    {
+      push(BB);
+    }
+  }
+
+  // Removes and returns the pending basic block that comes first in reverse postorder
+  llvm::BasicBlock *pop()
+  {
+    int rpo_number = queue.top();
+
+    queue.pop();
+    pending.reset(rpo_number);
+
+    return blocks[rpo_number];
+  }
+
+  bool empty() const
+  {
+    return queue.empty();
+  }
+
+  // Returns the basic blocks of the function in reverse postorder
+  const std::vector<llvm::BasicBlock *> &getBlocks() const
+  {
+    return blocks;
+  }
+
+private:
+  std::vector<llvm::BasicBlock *> blocks; // Reverse postorder number -> basic block
+  llvm::DenseMap<llvm::BasicBlock *, int> rpo_numbers;  // Basic block -> reverse postorder number
+  llvm::BitVector pending; // Reverse postorder numbers of the basic blocks in the worklist
+  std::priority_queue<int, std::vector<int>, std::greater<int>> queue; // Pending reverse postorder numbers, smallest first
+};
+
+#endif
@@ -4,219 +4,536 @@
 
 #include "llvm/IR/LegacyPassManager.h"
 
+#include <algorithm>
 #include <map>
+#include <vector>
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Instructions.h"
+#include "llvm/IR/ValueHandle.h"
 #include "llvm/IR/CFG.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/Analysis/IteratedDominanceFrontier.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Transforms/Utils/Local.h"
+
+#include "../Common/fixpoint_trace.h"
+#include "../Common/rpo_worklist.h"
 
 using namespace llvm;
 
+#define DEBUG_TYPE "cons_eval"
+
+STATISTIC(NumFunctionPops, "Number of functions taken from the interprocedural worklist");
+STATISTIC(NumWorklistPops, "Number of basic blocks and cells taken from the worklists");
+STATISTIC(NumTransfers, "Number of transfer function evaluations");
+STATISTIC(NumMeets, "Number of meet operations at PHI nodes and selects");
+STATISTIC(NumLatticeSize, "Number of lattice cells (instructions and memory PHI nodes) at convergence");
+
+static cl::opt<bool> ConsPrintWork("cons-print-work", cl::init(false),
+                                   cl::desc("Print the fixpoint counters of cons_eval_given as a JSON object to the standard error"));
+
+static cl::opt<std::string> ConsTrace("cons-trace", cl::init(""),
+                                      cl::desc("Write a Chrome trace of the time and fixpoint counters of each analysis of a function to this file"));
+
 namespace {
+// A value of the constant lattice, packed into eight bytes
+struct lattice_value
+{
+  enum kind_type : int32_t
+  {
+    TOP_KIND,       // No value has reached this point yet
+    CONSTANT_KIND,
+    BOTTOM_KIND     // Not a constant
+  };
+
+  kind_type kind;
+  int32_t constant; // Zero unless the kind is CONSTANT_KIND
+
+  bool operator==(const lattice_value &other) const
+  {
+    return kind == other.kind && constant == other.constant;
+  }
+
+  bool operator!=(const lattice_value &other) const
+  {
+    return !(*this == other);
+  }
+};
+
+// A PHI node of a memory variable, at a basic block in the iterated dominance frontier of the stores to the variable
+struct memory_phi
+{
+  BasicBlock *block;
+  Value *variable;
+  std::vector<std::pair<BasicBlock *, unsigned>> incoming; // (Predecessor, cell of the definition of the variable reaching the end of the predecessor)
+};
+
+// The sparse state of the analysis of a function, with one lattice cell per SSA value
+// Memory is put in SSA form as well: the variables are the pointers that are loaded from or stored to, every store defines its variable, and every load reads the single definition of its variable that reaches it
+struct function_state
+{
+  static const unsigned TOP_CELL = 0;    // The definition of an uninitialized alloca at the entry of the function
+  static const unsigned BOTTOM_CELL = 1; // The definition of any other variable at the entry of the function, and by scanf and calls
+  static const unsigned FIRST_CELL = 2;  // Instructions, in program order, then memory PHI nodes
+
+  DenseMap<Value *, unsigned> numbers;     // Instruction -> cell
+  std::vector<Instruction *> instructions; // Cell - FIRST_CELL -> instruction
+  std::vector<memory_phi> memory_phis;     // Cell - FIRST_CELL - number of instructions -> memory PHI node
+  DenseMap<BasicBlock *, std::vector<unsigned>> block_memory_phis; // Basic block -> cells of its memory PHI nodes
+  DenseMap<Instruction *, unsigned> reaching_definitions;          // Load -> cell of the store (or memory PHI node) whose value it reads
+  std::vector<std::vector<unsigned>> users;                        // Cell -> cells computed from it
+  std::vector<lattice_value> cells;
+
+  DenseSet<BasicBlock *> executable_blocks;
+  DenseSet<std::pair<BasicBlock *, BasicBlock *>> executable_edges;
+  DenseSet<BasicBlock *> resolved_blocks; // Basic blocks whose terminator takes every successor while its condition is TOP
+  std::vector<unsigned> cell_worklist; // Cells whose operands have changed
+  BitVector pending;                   // Cells in cell_worklist
+
+  bool isMemoryPHI(unsigned cell) const
+  {
+    return cell >= FIRST_CELL + instructions.size();
+  }
+
+  memory_phi &getMemoryPHI(unsigned cell)
+  {
+    return memory_phis[cell - FIRST_CELL - instructions.size()];
+  }
+};
+
 struct cons_eval : public ModulePass {
   static char ID;
   cons_eval() : ModulePass(ID) {}
 
-  const std::pair<int, bool> TOP = std::make_pair(-1, false), BOTTOM = std::make_pair(0, false);
+  const lattice_value TOP = {lattice_value::TOP_KIND, 0}, BOTTOM = {lattice_value::BOTTOM_KIND, 0};
 
-  std::map <Function *, std::map<Value *, std::pair<int, bool>>> arguments;
-  std::map <Function *, std::pair<int, bool>> return_values;
+  std::map <Function *, std::map<Value *, lattice_value>> arguments;
+  std::map <Function *, lattice_value> return_values;
   std::map <Function *, std::set<Function *>> callers;
   std::set <Function *> worklist;
-  std::map <Function *, std::map<Instruction *, std::map<Value *, std::pair<int, bool>>>> out;
+  std::map <Function *, function_state> states;
+  bool resolve_undefined = false;    // Whether the fixpoint of all the functions has been reached once
+  uint64_t function_iterations = 0;  // Functions taken from the worklist, for -cons-print-work
+  fixpoint_counters counters, total_counters; // Work done by the current analysis of a function, and by all of them
 
-  std::pair<int, bool> meet(std::pair<int, bool> pair1, std::pair<int, bool> pair2)
+  lattice_value getConstant(int32_t constant)
   {
-    if (pair1 == BOTTOM || pair2 == BOTTOM)
-    {
-      pair1 = BOTTOM;
-    }
-    else if (pair1 == TOP && pair2 == TOP)
-    {
-      pair1 = TOP;
-    }
-    else if (pair1 == TOP)
+    return {lattice_value::CONSTANT_KIND, constant};
+  }
+
+  lattice_value meet(lattice_value value1, lattice_value value2)
+  {
+    if (value1 == TOP)
     {
-      pair1 = pair2;
+      return value2;
     }
-    else if (pair2 != TOP && pair1 != pair2)
+    else if (value2 != TOP && value1 != value2)
     {
-      pair1 = BOTTOM;
+      return BOTTOM;
     }
 
-    return pair1;
+    return value1;
   }
 
-  std::map<Value *, std::pair<int, bool>> meet(std::map<Value *, std::pair<int, bool>> map1, std::map<Value *, std::pair<int, bool>> map2)
+  std::map<Value *, lattice_value> meet(std::map<Value *, lattice_value> map1, std::map<Value *, lattice_value> map2)
   {
     for (auto &pair : map1)
     {
-      map1[pair.first] = meet(map1[pair.first], map2[pair.first]);
+      map1[pair.first] = meet(map1[pair.first], map2.count(pair.first) ? map2[pair.first] : BOTTOM);
     }
 
     return map1;
   }
 
-  std::map<Value *, std::pair<int, bool>> calculate_effect(Instruction *I, Instruction *prev_instruction)
+  // Numbers the cells of the function, and puts its memory in SSA form
+  void buildState(Function &F)
   {
-    std::map<Value *, std::pair<int, bool>> effect;
-    Value *op1, *op2;
-    std::pair<int, bool> value1, value2;
-    Function *F;
-    std::map<Value *, std::pair<int, bool>> actual_arguments, old_arguments;
+    function_state &state = states[&F];
+    DominatorTree DT(F);
+    std::vector<Value *> variables, global_variables;
+    DenseMap<Value *, SmallPtrSet<BasicBlock *, 8>> definition_blocks;
+    DenseMap<Value *, unsigned> current;              // Variable -> cell of its definition reaching the current program point
+    std::vector<std::pair<Value *, unsigned>> log;    // Variable and its previous definition, for each definition of the current dominator tree path
+    std::vector<std::pair<DomTreeNode *, size_t>> path;  // Dominator tree node, and the size of the log on entering it
+    std::vector<unsigned> next_child;
+    unsigned cell = function_state::FIRST_CELL;
 
-    if (prev_instruction)
+    for (BasicBlock &BB : F)
     {
-      effect = out[prev_instruction->getFunction()][prev_instruction];
+      state.block_memory_phis[&BB] = std::vector<unsigned>();
+
+      for (Instruction &I : BB)
+      {
+        state.numbers[&I] = cell++;
+        state.instructions.push_back(&I);
+
+        if (isa<LoadInst>(I) || isa<StoreInst>(I))
+        {
+          Value *pointer = getLoadStorePointerOperand(&I);
+
+          if (current.find(pointer) == current.end())
+          {
+            // Allocas are undefined until their first store, anything else may hold any value
+            current[pointer] = isa<AllocaInst>(pointer) ? function_state::TOP_CELL : function_state::BOTTOM_CELL;
+            variables.push_back(pointer);
+
+            if (isa<GlobalVariable>(pointer))
+            {
+              global_variables.push_back(pointer);
+            }
+          }
+        }
+      }
     }
-    else
+
+    for (BasicBlock &BB : F)
     {
-      effect = out[I->getFunction()][I];
+      for (Instruction &I : BB)
+      {
+        for (Value *variable : getDefinedVariables(&I, current, global_variables))
+        {
+          definition_blocks[variable].insert(&BB);
+        }
+      }
     }
 
-    if (I->isBinaryOp())
+    for (Value *variable : variables)
     {
-      op1 = I->getOperand(0);
-      if (dyn_cast<Constant>(op1) == NULL)
+      ForwardIDFCalculator IDF(DT);
+      SmallVector<BasicBlock *, 32> phi_blocks;
+
+      IDF.setDefiningBlocks(definition_blocks[variable]);
+      IDF.calculate(phi_blocks);
+
+      for (BasicBlock *BB : phi_blocks)
       {
-        value1 = effect[op1];
+        state.block_memory_phis[BB].push_back(cell++);
+        state.memory_phis.push_back({BB, variable, {}});
       }
-      else
+    }
+
+    state.users.resize(cell);
+    state.cells.resize(cell);
+    state.pending.resize(cell);
+
+    for (Instruction *I : state.instructions)
+    {
+      for (Value *op : I->operands())
       {
-        value1 = std::make_pair(dyn_cast<Constant>(op1)->getUniqueInteger().getSExtValue(), true);
+        if (isa<Instruction>(op))
+        {
+          state.users[state.numbers[op]].push_back(state.numbers[I]);
+        }
       }
+    }
+
+    // Renaming the variables along the dominator tree, as in the construction of SSA form
+    path.push_back({DT.getRootNode(), 0});
+    next_child.push_back(0);
+    renameMemory(state, DT.getRootNode()->getBlock(), current, global_variables, log);
 
-      op2 = I->getOperand(1);
-      if (dyn_cast<Constant>(op2) == NULL)
+    while (!path.empty())
+    {
+      DomTreeNode *node = path.back().first;
+
+      if (next_child.back() < node->getNumChildren())
       {
-        value2 = effect[op2];
+        DomTreeNode *child = *(node->begin() + next_child.back()++);
+
+        path.push_back({child, log.size()});
+        next_child.push_back(0);
+        renameMemory(state, child->getBlock(), current, global_variables, log);
       }
       else
       {
-        value2 = std::make_pair(dyn_cast<Constant>(op2)->getUniqueInteger().getSExtValue(), true);
+        while (log.size() > path.back().second)
+        {
+          current[log.back().first] = log.back().second;
+          log.pop_back();
+        }
+
+        path.pop_back();
+        next_child.pop_back();
       }
+    }
+  }
+
+  // Returns the variables which the instruction I writes
+  std::vector<Value *> getDefinedVariables(Instruction *I, DenseMap<Value *, unsigned> &current, const std::vector<Value *> &global_variables)
+  {
+    std::vector<Value *> defined;
+    Function *F;
+
+    if (isa<StoreInst>(I))
+    {
+      defined.push_back(I->getOperand(1));
+    }
+    else if (isa<CallInst>(I))
+    {
+      F = dyn_cast<CallInst>(I)->getCalledFunction();
 
-      if (value1 == BOTTOM || value2 == BOTTOM)
+      if (F != NULL && F->getName() == "__isoc99_scanf")  // scanf writes the variables passed to it
       {
-        effect[I] = BOTTOM;
+        for (Value *op : I->operands())
+        {
+          if (current.find(op) != current.end() && std::find(defined.begin(), defined.end(), op) == defined.end())
+          {
+            defined.push_back(op);
+          }
+        }
       }
-      else if (value1 == TOP || value2 == TOP)
+      else if (F == NULL || F->getName() != "printf")  // Other calls may write the global variables
       {
-        effect[I] = TOP;
+        defined = global_variables;
       }
-      else
+    }
+
+    return defined;
+  }
+
+  // Links the loads and memory PHI nodes of the basic block to the definitions reaching them, and updates the current definitions of the variables
+  void renameMemory(function_state &state, BasicBlock *BB, DenseMap<Value *, unsigned> &current, const std::vector<Value *> &global_variables,
+                    std::vector<std::pair<Value *, unsigned>> &log)
+  {
+    unsigned definition;
+
+    for (unsigned cell : state.block_memory_phis[BB])
+    {
+      log.push_back({state.getMemoryPHI(cell).variable, current[state.getMemoryPHI(cell).variable]});
+      current[state.getMemoryPHI(cell).variable] = cell;
+    }
+
+    for (Instruction &I : *BB)
+    {
+      if (isa<LoadInst>(I))
       {
-        if (I->getOpcode() == Instruction::Add)
-        {
-          effect[I] = std::make_pair(value1.first + value2.first, true);
-        }
-        else if (I->getOpcode() == Instruction::Sub)
-        {
-          effect[I] = std::make_pair(value1.first - value2.first, true);
-        }
-        else if (I->getOpcode() == Instruction::Mul)
-        {
-          effect[I] = std::make_pair(value1.first * value2.first, true);
-        }
-        else if (I->getOpcode() == Instruction::UDiv)
-        {
-          effect[I] = std::make_pair(static_cast<unsigned int>(value1.first / value2.first), true);
-        }
-        else if (I->getOpcode() == Instruction::SDiv)
-        {
-          effect[I] = std::make_pair(value1.first / value2.first, true);
-        }
-        else if (I->getOpcode() == Instruction::URem)
-        {
-          effect[I] = std::make_pair(static_cast<unsigned int>(value1.first % value2.first), true);
-        }
-        else if (I->getOpcode() == Instruction::SRem)
-        {
-          effect[I] = std::make_pair(value1.first % value2.first, true);
-        }
-        else if (I->getOpcode() == Instruction::Shl)
-        {
-          effect[I] = std::make_pair(value1.first << value2.first, true);
-        }
-        else if (I->getOpcode() == Instruction::LShr)
-        {
-          effect[I] = std::make_pair(value1.first >> static_cast<unsigned int>(value2.first), true);
-        }
-        else if (I->getOpcode() == Instruction::AShr)
-        {
-          effect[I] = std::make_pair(value1.first >> value2.first, true);
-        }
-        else if (I->getOpcode() == Instruction::And)
-        {
-          effect[I] = std::make_pair(value1.first & value2.first, true);
-        }
-        else if (I->getOpcode() == Instruction::Or)
-        {
-          effect[I] = std::make_pair(value1.first | value2.first, true);
-        }
-        else if (I->getOpcode() == Instruction::Xor)
-        {
-          effect[I] = std::make_pair(value1.first ^ value2.first, true);
-        }
+        definition = current[I.getOperand(0)];
+        state.reaching_definitions[&I] = definition;
+        state.users[definition].push_back(state.numbers[&I]);
+      }
+
+      for (Value *variable : getDefinedVariables(&I, current, global_variables))
+      {
+        log.push_back({variable, current[variable]});
+        current[variable] = isa<StoreInst>(I) ? state.numbers[&I] : function_state::BOTTOM_CELL;
       }
     }
-    else if (isa<LoadInst>(I))
+
+    for (BasicBlock *succ : successors(BB))
+    {
+      for (unsigned cell : state.block_memory_phis[succ])
+      {
+        definition = current[state.getMemoryPHI(cell).variable];
+        state.getMemoryPHI(cell).incoming.push_back({BB, definition});
+        state.users[definition].push_back(cell);
+      }
+    }
+  }
+
+  // The value of an operand in the function F
+  lattice_value getValue(Value *V, Function *F, function_state &state)
+  {
+    if (ConstantInt *C = dyn_cast<ConstantInt>(V))
     {
-      effect[I] = effect[I->getOperand(0)];
+      return getConstant(C->getSExtValue());
     }
-    else if (isa<StoreInst>(I))
+
+    if (isa<Argument>(V))
     {
-      op1 = I->getOperand(0);
-      if (dyn_cast<Constant>(op1) == NULL)
+      auto argument = arguments[F].find(V);
+      return argument == arguments[F].end() ? BOTTOM : argument->second;
+    }
+
+    auto number = state.numbers.find(V);
+    return number == state.numbers.end() ? BOTTOM : state.cells[number->second];
+  }
+
+  // Evaluates the binary operator I on integers of at most 32 bits, which are held sign extended to 32 bits
+  // Divisions by zero and signed divisions which overflow are undefined, and shifts by the bit width or more give poison, so they are not folded
+  lattice_value evaluate(BinaryOperator *I, lattice_value value1, lattice_value value2)
+  {
+    Type *type = I->getType();
+    unsigned width;
+    APInt constant1, constant2, result;
+
+    if (!type->isIntegerTy() || type->getIntegerBitWidth() > 32 || value1 == BOTTOM || value2 == BOTTOM)
+    {
+      return BOTTOM;
+    }
+    else if (value1 == TOP || value2 == TOP)
+    {
+      return TOP;
+    }
+
+    width = type->getIntegerBitWidth();
+    constant1 = APInt(width, value1.constant, true);
+    constant2 = APInt(width, value2.constant, true);
+
+    switch (I->getOpcode())
+    {
+    case Instruction::Add:
+      result = constant1 + constant2;
+      break;
+    case Instruction::Sub:
+      result = constant1 - constant2;
+      break;
+    case Instruction::Mul:
+      result = constant1 * constant2;
+      break;
+    case Instruction::UDiv:
+    case Instruction::URem:
+      if (constant2.isZero())
       {
-        if (effect.find(op1) == effect.end())
-        {
-          value1 = arguments[prev_instruction->getFunction()][op1];
-        }
-        else
-        {
-          value1 = effect[op1];
-        }
+        return BOTTOM;
+      }
+      result = I->getOpcode() == Instruction::UDiv ? constant1.udiv(constant2) : constant1.urem(constant2);
+      break;
+    case Instruction::SDiv:
+    case Instruction::SRem:
+      if (constant2.isZero() || (constant1.isMinSignedValue() && constant2.isAllOnesValue()))  // INT_MIN / -1
+      {
+        return BOTTOM;
+      }
+      result = I->getOpcode() == Instruction::SDiv ? constant1.sdiv(constant2) : constant1.srem(constant2);
+      break;
+    case Instruction::Shl:
+    case Instruction::LShr:
+    case Instruction::AShr:
+      if (constant2.uge(width))
+      {
+        return BOTTOM;
+      }
+      else if (I->getOpcode() == Instruction::Shl)
+      {
+        result = constant1.shl(constant2);
+      }
+      else if (I->getOpcode() == Instruction::LShr)
+      {
+        result = constant1.lshr(constant2);
       }
       else
       {
-        value1 = std::make_pair(dyn_cast<Constant>(op1)->getUniqueInteger().getSExtValue(), true);
+        result = constant1.ashr(constant2);
       }
+      break;
+    case Instruction::And:
+      result = constant1 & constant2;
+      break;
+    case Instruction::Or:
+      result = constant1 | constant2;
+      break;
+    case Instruction::Xor:
+      result = constant1 ^ constant2;
+      break;
+    default:
+      return BOTTOM;
+    }
+
+    return getConstant(result.getSExtValue());
+  }
+
+  // Evaluates the comparison I of two integers of at most 32 bits, which are held sign extended to 32 bits
+  lattice_value evaluateComparison(ICmpInst *I, lattice_value value1, lattice_value value2)
+  {
+    Type *type = I->getOperand(0)->getType();
+
+    if (!type->isIntegerTy() || type->getIntegerBitWidth() > 32 || value1 == BOTTOM || value2 == BOTTOM)
+    {
+      return BOTTOM;
+    }
+    else if (value1 == TOP || value2 == TOP)
+    {
+      return TOP;
+    }
+
+    // True is -1, as the sign extension of the i1 constant true
+    return getConstant(ICmpInst::compare(APInt(type->getIntegerBitWidth(), value1.constant, true), APInt(type->getIntegerBitWidth(), value2.constant, true), I->getPredicate()) ? -1 : 0);
+  }
+
+  // Evaluates the extension or truncation I between integers of at most 32 bits, such as the zext of a comparison to an int
+  lattice_value evaluateCast(CastInst *I, lattice_value value)
+  {
+    Type *source = I->getSrcTy(), *destination = I->getDestTy();
+    APInt constant;
+
+    if (!source->isIntegerTy() || !destination->isIntegerTy() || source->getIntegerBitWidth() > 32 || destination->getIntegerBitWidth() > 32 || value == BOTTOM)
+    {
+      return BOTTOM;
+    }
+    else if (value == TOP)
+    {
+      return TOP;
+    }
+
+    constant = APInt(source->getIntegerBitWidth(), value.constant, true);
+
+    if (isa<ZExtInst>(I))
+    {
+      constant = constant.zext(destination->getIntegerBitWidth());
+    }
+    else if (isa<SExtInst>(I))
+    {
+      constant = constant.sext(destination->getIntegerBitWidth());
+    }
+    else if (isa<TruncInst>(I))
+    {
+      constant = constant.trunc(destination->getIntegerBitWidth());
+    }
+    else
+    {
+      return BOTTOM;
+    }
+
+    return getConstant(constant.getSExtValue());
+  }
 
-      effect[I->getOperand(1)] = value1;
+  // Evaluates the instruction I on the current values of its operands, and returns the value of its cell
+  // For a store, this is the value stored, which loads of the variable read through the store's cell
+  lattice_value calculate_effect(Instruction *I, function_state &state)
+  {
+    Function *F, *caller = I->getFunction();
+    std::map<Value *, lattice_value> actual_arguments, old_arguments;
+    lattice_value value1, value2, value = BOTTOM;
+
+    counters.transfers++;
+
+    if (I->isBinaryOp())
+    {
+      value1 = getValue(I->getOperand(0), caller, state);
+      value2 = getValue(I->getOperand(1), caller, state);
+      value = evaluate(cast<BinaryOperator>(I), value1, value2);
+    }
+    else if (isa<LoadInst>(I))
+    {
+      value = state.cells[state.reaching_definitions[I]];
+    }
+    else if (isa<StoreInst>(I))
+    {
+      value = getValue(I->getOperand(0), caller, state);
     }
     else if (isa<CallInst>(I))
     {
       F = dyn_cast<CallInst>(I)->getCalledFunction();
 
-      if (F->getName() == "__isoc99_scanf")
-      {
-        for (Value *op : I->operands())
-        {
-          if (effect.find(op) != effect.end())
-          {
-            effect[op] = BOTTOM;
-          }
-        }
-      }
-      else if (F->getName() != "printf")
+      if (F != NULL && F->getName() != "__isoc99_scanf" && F->getName() != "printf")
       {
         if (F->getReturnType()->isIntegerTy(32))
         {
-          effect[I] = return_values[F];
+          value = return_values[F];
         }
 
-        for (Value *op : I->operands())
+        for (unsigned i = 0; i < dyn_cast<CallInst>(I)->arg_size() && i < F->arg_size(); i++)
         {
+          Value *op = dyn_cast<CallInst>(I)->getArgOperand(i);
+
           if (op->getType()->isIntegerTy(32))
           {
-            if (dyn_cast<Constant>(op) == NULL)
-            {
-              actual_arguments[F->arg_begin() + std::distance(I->op_begin(), std::find(I->op_begin(), I->op_end(), op))] = effect[op];
-            }
-            else
-            {
-              actual_arguments[F->arg_begin() + std::distance(I->op_begin(), std::find(I->op_begin(), I->op_end(), op))] = std::make_pair(dyn_cast<Constant>(op)->getUniqueInteger().getSExtValue(), true);
-            }
+            actual_arguments[F->getArg(i)] = getValue(op, caller, state);
           }
         }
 
@@ -227,112 +544,339 @@ struct cons_eval : public ModulePass {
           worklist.insert(F);
         }
 
-        callers[F].insert(I->getFunction());
+        callers[F].insert(caller);
       }
     }
     else if (isa<ReturnInst>(I))
     {
-      if (I->getFunction()->getReturnType()->isIntegerTy(32))
+      if (caller->getReturnType()->isIntegerTy(32))
       {
-        op1 = I->getOperand(0);
-        if (dyn_cast<Constant>(op1) == NULL)
+        value1 = getValue(I->getOperand(0), caller, state);
+
+        value2 = return_values[caller];
+        return_values[caller] = meet(value2, value1);
+        if (return_values[caller] != value2)
         {
-          value1 = effect[op1];
+          for (Function *F : callers[caller])
+          {
+            worklist.insert(F);
+          }
         }
-        else
+      }
+    }
+    else if (PHINode *phi = dyn_cast<PHINode>(I))
+    {
+      counters.meets++;
+      value = TOP;
+
+      for (unsigned i = 0; i < phi->getNumIncomingValues(); i++)
+      {
+        if (state.executable_edges.count({phi->getIncomingBlock(i), phi->getParent()}))
         {
-          value1 = std::make_pair(dyn_cast<Constant>(op1)->getUniqueInteger().getSExtValue(), true);
+          value = meet(value, getValue(phi->getIncomingValue(i), caller, state));
         }
+      }
+    }
+    else if (ICmpInst *comparison = dyn_cast<ICmpInst>(I))
+    {
+      value1 = getValue(I->getOperand(0), caller, state);
+      value2 = getValue(I->getOperand(1), caller, state);
+      value = evaluateComparison(comparison, value1, value2);
+    }
+    else if (CastInst *conversion = dyn_cast<CastInst>(I))
+    {
+      value = evaluateCast(conversion, getValue(I->getOperand(0), caller, state));
+    }
+    else if (SelectInst *select = dyn_cast<SelectInst>(I))
+    {
+      value1 = getValue(select->getCondition(), caller, state);
 
-        value2 = return_values[I->getFunction()];
-        return_values[I->getFunction()] = meet(value2, value1);
-        if (return_values[I->getFunction()] != value2)
+      if (value1 == TOP)
+      {
+        value = TOP;
+      }
+      else if (value1 == BOTTOM)
+      {
+        counters.meets++;
+        value = meet(getValue(select->getTrueValue(), caller, state), getValue(select->getFalseValue(), caller, state));
+      }
+      else
+      {
+        value = getValue(value1.constant != 0 ? select->getTrueValue() : select->getFalseValue(), caller, state);
+      }
+    }
+
+    return value;
+  }
+
+  // Lowers the cell to its meet with the value, and schedules the cells computed from it if it has changed
+  void update(function_state &state, unsigned cell, lattice_value value)
+  {
+    value = meet(state.cells[cell], value);
+
+    if (value != state.cells[cell])
+    {
+      state.cells[cell] = value;
+
+      for (unsigned user : state.users[cell])
+      {
+        if (!state.pending.test(user))
         {
-          for (Function *F : callers[I->getFunction()])
-          {
-            worklist.insert(F);
-          }
+          state.pending.set(user);
+          state.cell_worklist.push_back(user);
         }
       }
     }
-    else if (isa<PHINode>(I))
+  }
+
+  // Marks the CFG edge from -> to as executable
+  // The basic block to is scheduled if it has become executable, and otherwise its PHI nodes are, since their meet now includes the edge
+  void markExecutable(function_state &state, BasicBlock *from, BasicBlock *to, rpo_worklist &block_worklist)
+  {
+    if (!state.executable_edges.insert({from, to}).second)
+    {
+      return;
+    }
+
+    if (state.executable_blocks.insert(to).second)
     {
-      effect[I] = BOTTOM;
+      block_worklist.push(to);
+      return;
     }
-    else if (isa<SelectInst>(I))
+
+    for (PHINode &phi : to->phis())
     {
-      effect[I] = BOTTOM;
+      visit(state, state.numbers[&phi], block_worklist);
     }
 
-    return effect;
+    for (unsigned cell : state.block_memory_phis[to])
+    {
+      visit(state, cell, block_worklist);
+    }
   }
 
-  void intraprocedural_constant_propagation(Function &F)
+  // Recomputes the value of the cell, if it belongs to an executable basic block
+  void visit(function_state &state, unsigned cell, rpo_worklist &block_worklist)
   {
-    std::map<Value *, std::pair<int, bool>> initial_map, new_out;
-    std::set <Instruction *> instruction_worklist;
-    Instruction *I, *prev_instruction, *next_instruction;
+    Instruction *I;
+    lattice_value value;
 
-    for (BasicBlock &BB : F)
+    if (state.isMemoryPHI(cell))
     {
-      for (Instruction &I : BB)
+      memory_phi &phi = state.getMemoryPHI(cell);
+
+      if (state.executable_blocks.count(phi.block))
       {
-        if (!isa<StoreInst>(I) && !isa<ICmpInst>(I) && !isa<BranchInst>(I) && !isa<ReturnInst>(I) && !isa<ZExtInst>(I))
+        counters.meets++;
+        value = TOP;
+
+        for (auto &incoming : phi.incoming)
         {
-          initial_map[&I] = TOP;
+          if (state.executable_edges.count({incoming.first, phi.block}))
+          {
+            value = meet(value, state.cells[incoming.second]);
+          }
         }
+
+        update(state, cell, value);
+      }
+
+      return;
+    }
+
+    I = state.instructions[cell - function_state::FIRST_CELL];
+    if (!state.executable_blocks.count(I->getParent()))
+    {
+      return;
+    }
+
+    update(state, cell, calculate_effect(I, state));
+
+    if (I->isTerminator())
+    {
+      for (BasicBlock *succ : getFeasibleSuccessors(I, state))
+      {
+        markExecutable(state, I->getParent(), succ, block_worklist);
+      }
+    }
+  }
+
+  // Returns the successors of the terminator I which may be taken, given the value of its condition
+  std::vector<BasicBlock *> getFeasibleSuccessors(Instruction *I, function_state &state)
+  {
+    BranchInst *BI = dyn_cast<BranchInst>(I);
+    SwitchInst *SI = dyn_cast<SwitchInst>(I);
+    lattice_value condition;
+
+    if ((BI != NULL && BI->isConditional()) || (SI != NULL && SI->getCondition()->getType()->getIntegerBitWidth() <= 32))
+    {
+      condition = getValue(BI != NULL ? BI->getCondition() : SI->getCondition(), I->getFunction(), state);
+
+      if (condition == TOP && !state.resolved_blocks.count(I->getParent()))  // No value of the condition has reached the terminator yet
+      {
+        return std::vector<BasicBlock *>();
+      }
+      else if (condition.kind == lattice_value::CONSTANT_KIND && BI != NULL)
+      {
+        return std::vector<BasicBlock *>(1, BI->getSuccessor(condition.constant != 0 ? 0 : 1));
+      }
+      else if (condition.kind == lattice_value::CONSTANT_KIND)
+      {
+        return std::vector<BasicBlock *>(1, SI->findCaseValue(ConstantInt::get(cast<IntegerType>(SI->getCondition()->getType()), condition.constant, true))->getCaseSuccessor());
       }
     }
 
+    return std::vector<BasicBlock *>(succ_begin(I), succ_end(I));
+  }
+
+  // Returns the executable basic blocks of F whose terminator takes no successor, since its condition is still TOP
+  // After the first fixpoint of all the functions, such a condition will never get a value (it depends on a variable that is never stored to)
+  std::vector<BasicBlock *> getUndefinedConditions(Function &F, function_state &state)
+  {
+    std::vector<BasicBlock *> blocks;
+
     for (BasicBlock &BB : F)
     {
-      for (Instruction &I : BB)
+      if (state.executable_blocks.count(&BB) && BB.getTerminator()->getNumSuccessors() > 0 && getFeasibleSuccessors(BB.getTerminator(), state).empty())
       {
-        out[&F][&I] = initial_map;
-        instruction_worklist.insert(&I);
+        blocks.push_back(&BB);
       }
     }
 
-    while (!instruction_worklist.empty())
+    return blocks;
+  }
+
+  // Replaces the condition of the terminator of BB by its value, if it is a constant, and folds the terminator into an unconditional branch
+  void foldTerminator(BasicBlock &BB, function_state &state)
+  {
+    BranchInst *BI = dyn_cast<BranchInst>(BB.getTerminator());
+    SwitchInst *SI = dyn_cast<SwitchInst>(BB.getTerminator());
+    Value *condition = NULL;
+    ConstantInt *constant;
+    lattice_value value;
+
+    if (BI != NULL && BI->isConditional())
+    {
+      condition = BI->getCondition();
+    }
+    else if (SI != NULL)
+    {
+      condition = SI->getCondition();
+    }
+
+    if (condition == NULL || condition->getType()->getIntegerBitWidth() > 32)
+    {
+      return;
+    }
+
+    value = getValue(condition, BB.getParent(), state);
+    if (value.kind == lattice_value::CONSTANT_KIND)
     {
-      I = *instruction_worklist.begin();
-      instruction_worklist.erase(I);
-      prev_instruction = I->getPrevNode();
-      if (prev_instruction || I == F.getEntryBlock().getFirstNonPHI())
+      constant = ConstantInt::get(cast<IntegerType>(condition->getType()), value.constant, true);
+
+      if (BI != NULL)
       {
-        new_out = calculate_effect(I, prev_instruction);
+        BI->setCondition(constant);
       }
       else
       {
-        new_out = initial_map;
-        for (BasicBlock *pred : predecessors(I->getParent()))
-        {
-          prev_instruction = pred->getTerminator();
-          new_out = meet(new_out, calculate_effect(I, prev_instruction));
-        }
+        SI->setCondition(constant);
+      }
+    }
+
+    WeakTrackingVH old_condition(condition);  // Folding removes BB from the PHI nodes of the dropped successors, which may erase a PHI node used as the condition
+
+    ConstantFoldTerminator(&BB);
+
+    if (old_condition && isa<Instruction>(old_condition))  // Deleting the old condition (and what only it used), if the branch was its last use
+    {
+      RecursivelyDeleteTriviallyDeadInstructions(old_condition);
+    }
+  }
+
+  // Propagates until both worklists are empty
+  void solve(function_state &state, rpo_worklist &block_worklist)
+  {
+    BasicBlock *BB;
+    unsigned cell;
+
+    while (!block_worklist.empty() || !state.cell_worklist.empty())
+    {
+      while (!state.cell_worklist.empty())
+      {
+        cell = state.cell_worklist.back();
+        state.cell_worklist.pop_back();
+        state.pending.reset(cell);
+        counters.worklist_pops++;
+
+        visit(state, cell, block_worklist);
       }
 
-      if (new_out != out[&F][I])
+      if (!block_worklist.empty())
       {
-        out[&F][I] = new_out;
-        next_instruction = I->getNextNode();
+        BB = block_worklist.pop();
+        counters.worklist_pops++;
 
-        if (next_instruction)
+        for (unsigned cell : state.block_memory_phis[BB])
         {
-          instruction_worklist.insert(next_instruction);
+          visit(state, cell, block_worklist);
         }
-        else
+
+        for (Instruction &I : *BB)
         {
-          for (BasicBlock *succ : successors(I->getParent()))
-          {
-            next_instruction = succ->getFirstNonPHI();
-            instruction_worklist.insert(next_instruction);
-          }
+          visit(state, state.numbers[&I], block_worklist);
         }
       }
     }
   }
 
+  // Sparse conditional constant propagation (Wegman and Zadeck) over the SSA values and the SSA form of the memory of the function
+  void intraprocedural_constant_propagation(Function &F, fixpoint_trace &trace)
+  {
+    function_state &state = states[&F];
+    rpo_worklist block_worklist(F);  // Basic blocks which have become executable, and whose instructions have not been evaluated yet
+    std::vector<BasicBlock *> undefined;
+
+    counters = fixpoint_counters();
+    function_timer timer(trace, "cons_eval", F, counters);
+
+    std::fill(state.cells.begin(), state.cells.end(), TOP);
+    state.cells[function_state::BOTTOM_CELL] = BOTTOM;
+    state.executable_blocks.clear();
+    state.executable_edges.clear();
+    state.resolved_blocks.clear();
+
+    state.executable_blocks.insert(&F.getEntryBlock());
+    block_worklist.push(&F.getEntryBlock());
+
+    solve(state, block_worklist);
+
+    // Letting the terminators whose condition will stay TOP take every successor, and propagating from there
+    while (resolve_undefined && !(undefined = getUndefinedConditions(F, state)).empty())
+    {
+      for (BasicBlock *BB : undefined)
+      {
+        state.resolved_blocks.insert(BB);
+
+        for (BasicBlock *succ : successors(BB))
+        {
+          markExecutable(state, BB, succ, block_worklist);
+        }
+      }
+
+      solve(state, block_worklist);
+    }
+
+    counters.lattice_size += state.cells.size();
+
+    NumWorklistPops += counters.worklist_pops;
+    NumTransfers += counters.transfers;
+    NumMeets += counters.meets;
+    NumLatticeSize += counters.lattice_size;
+
+    total_counters += counters;
+  }
+
   std::string getAsString(Value *V)
   {
     std::string s;
@@ -355,13 +899,15 @@ struct cons_eval : public ModulePass {
     // It is assumed that the opt tool is run from the llvm-project/build/ folder
 
     Function *F;
+    lattice_value value;
     bool flag;
+    fixpoint_trace trace(ConsTrace);
 
     for (auto &F : M)
     {
       if (F.getName() != "__isoc99_scanf" && F.getName() != "printf")
       {
-        arguments[&F] = std::map<Value *, std::pair<int, bool>>();
+        arguments[&F] = std::map<Value *, lattice_value>();
         for (Argument &Arg : F.args())
         {
           if (Arg.getType()->isIntegerTy(32))
@@ -372,21 +918,60 @@ struct cons_eval : public ModulePass {
 
         if (F.getReturnType()->isIntegerTy(32))
         {
-          return_values[&F] = TOP;
+          return_values[&F] = F.isDeclaration() ? BOTTOM : TOP;  // The results of external functions are unknown
         }
 
         callers[&F] = std::set<Function *>();
 
-        worklist.insert(&F);
+        if (!F.isDeclaration())
+        {
+          buildState(F);
+          worklist.insert(&F);
+        }
       }
     }
 
-    while (!worklist.empty())
+    do
     {
-      F = *worklist.begin();
-      worklist.erase(F);
-      intraprocedural_constant_propagation(*F);
+      while (!worklist.empty())
+      {
+        F = *worklist.begin();
+        worklist.erase(F);
+        function_iterations++;
+        NumFunctionPops++;
+        intraprocedural_constant_propagation(*F, trace);
+      }
+
+      if (!resolve_undefined)  // At the first fixpoint, analyzing again the functions with arguments or conditions that will stay TOP
+      {
+        resolve_undefined = true;
+
+        for (auto &F : M)
+        {
+          if (F.isDeclaration())
+          {
+            continue;
+          }
+
+          // The arguments which are still TOP come from functions without callers (such as external entry points), or from uninitialized variables
+          // They may hold any value, and the values computed from TOP would be folded as if the code using them never ran
+          for (auto &pair : arguments[&F])
+          {
+            if (pair.second == TOP)
+            {
+              pair.second = BOTTOM;
+              worklist.insert(&F);
+            }
+          }
+
+          if (!getUndefinedConditions(F, states[&F]).empty())
+          {
+            worklist.insert(&F);
+          }
+        }
+      }
     }
+    while (!worklist.empty());
 
     for (auto &F : M)
     {
@@ -406,7 +991,7 @@ struct cons_eval : public ModulePass {
           }
           else
           {
-            outs() << pair.second.first;
+            outs() << pair.second.constant;
           }
 
           if (pair.first != arguments[&F].rbegin()->first)
@@ -429,7 +1014,7 @@ struct cons_eval : public ModulePass {
           }
           else
           {
-            outs() << " -> " << return_values[&F].first;
+            outs() << " -> " << return_values[&F].constant;
           }
         }
 
@@ -437,16 +1022,34 @@ struct cons_eval : public ModulePass {
       }
     }
 
+    trace.write();
+
+    if (ConsPrintWork)
+    {
+      errs() << "{\"pass\":\"cons_eval_given\",\"worklist_iterations\":" << total_counters.worklist_pops << ",\"function_iterations\":" << function_iterations
+             << ",\"transfers\":" << total_counters.transfers << ",\"meets\":" << total_counters.meets << ",\"lattice_size\":" << total_counters.lattice_size << "}\n";
+    }
+
     for (auto &F : M)
     {
       for (auto &pair : arguments[&F])
       {
-        if (pair.second.second == true)
+        if (pair.second.kind == lattice_value::CONSTANT_KIND)
         {
-          pair.first->replaceAllUsesWith(ConstantInt::get(Type::getInt32Ty(M.getContext()), pair.second.first));
+          pair.first->replaceAllUsesWith(ConstantInt::get(Type::getInt32Ty(M.getContext()), pair.second.constant));
         }
       }
 
+      if (!F.isDeclaration())  // Folding the branches on constant conditions, and deleting the basic blocks which are no longer reachable
+      {
+        for (auto &BB : F)
+        {
+          foldTerminator(BB, states[&F]);
+        }
+
+        removeUnreachableBlocks(F);
+      }
+
       for (auto &BB : F)
       {
         for (auto I = BB.begin(); I != BB.end();)
@@ -454,9 +1057,10 @@ struct cons_eval : public ModulePass {
           flag = false;
           if (I->getType()->isIntegerTy(32))
           {
-            if (out[&F][&*I][&*I].second == true)
+            value = states[&F].cells[states[&F].numbers[&*I]];
+            if (value.kind == lattice_value::CONSTANT_KIND)
             {
-              I->replaceAllUsesWith(ConstantInt::get(Type::getInt32Ty(M.getContext()), out[&F][&*I][&*I].first));
+              I->replaceAllUsesWith(ConstantInt::get(Type::getInt32Ty(M.getContext()), value.constant));
               if (!isa<CallInst>(I))
               {
                 I = BB.getInstList().erase(I);
@@ -8,576 +8,4824 @@
 #include "llvm/IR/Instructions.h"
 #include <algorithm>
 #include <iterator>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include "llvm/IR/Module.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/SparseBitVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/SCCIterator.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/CallGraph.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/TypeFinder.h"
+#include "llvm/IR/ValueHandle.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Passes/PassPlugin.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/xxhash.h"
+
+#include "../Common/fixpoint_trace.h"
+#include "../Common/rpo_worklist.h"
 
 using namespace llvm;
 
+#define DEBUG_TYPE "alias_lib"
+
+STATISTIC(NumWorklistPops, "Number of worklist iterations (basic blocks, or solver steps for the flow-insensitive analyses)");
+STATISTIC(NumTransfers, "Number of transfer function evaluations (constraints generated, for the flow-insensitive analyses)");
+STATISTIC(NumMeets, "Number of meet operations (points-to set unions, for the flow-insensitive analyses)");
+STATISTIC(NumLatticeSize, "Number of (pointer, location) pairs in the points-to maps at convergence");
+
+enum alias_mode
+{
+  FLOW_SENSITIVE, // Flow-sensitive dataflow analysis over the CFG
+  ANDERSEN, // Flow-insensitive inclusion-based analysis
+  STEENSGAARD, // Flow-insensitive unification-based analysis
+  DEMAND_DRIVEN // Flow-insensitive inclusion-based analysis of only the pointers which the queries reach
+};
+
+static cl::opt<alias_mode> AliasMode("alias-mode", cl::init(FLOW_SENSITIVE), cl::desc("Precision of the alias_lib_given analysis"),
+                                     cl::values(clEnumValN(FLOW_SENSITIVE, "flow-sensitive", "Flow-sensitive analysis (default)"),
+                                                clEnumValN(ANDERSEN, "andersen", "Flow-insensitive inclusion-based analysis"),
+                                                clEnumValN(STEENSGAARD, "steensgaard", "Flow-insensitive unification-based analysis"),
+                                                clEnumValN(DEMAND_DRIVEN, "demand", "Demand-driven queries, as precise as the inclusion-based analysis")));
+
+static cl::opt<unsigned> AliasQueryBudget("alias-query-budget", cl::init(1000000),
+                                          cl::desc("Maximum number of steps of a demand-driven alias query, after which the pointers are assumed to alias (0 for no limit)"));
+
+static cl::opt<bool> AliasSSA("alias-ssa", cl::init(false),
+                              cl::desc("Track pointer SSA values (phis, selects, casts, loads, getelementptrs and call results) with one points-to set each, "
+                                       "for IR in SSA form such as after mem2reg"));
+
+static cl::opt<unsigned> AliasMaxFields("alias-max-fields", cl::init(0),
+                                        cl::desc("Maximum number of fields of a struct or array alloca with separate points-to sets, the rest sharing the last one "
+                                                 "(0 to fold every getelementptr onto its base, and to represent each array by its first element)"));
+
+static cl::opt<unsigned> AliasMaxInstructions("alias-max-instructions", cl::init(0),
+                                              cl::desc("Functions with more instructions are analyzed by the inclusion-based analysis instead of the flow-sensitive one "
+                                                       "(0 for no limit)"));
+
+static cl::opt<unsigned> AliasMaxWorklistPops("alias-max-worklist-pops", cl::init(0),
+                                              cl::desc("Maximum number of basic blocks taken from the worklist by the flow-sensitive analysis of a function, "
+                                                       "after which the function is analyzed by the inclusion-based analysis (0 for no limit)"));
+
+static cl::opt<unsigned> AliasMaxTime("alias-max-time-ms", cl::init(0),
+                                      cl::desc("Maximum time in milliseconds spent on the flow-sensitive or inclusion-based analysis of a function, "
+                                               "after which the function is analyzed by the next cheaper analysis (0 for no limit)"));
+
+static cl::opt<unsigned> MaxSCCRounds("alias-max-scc-rounds", cl::init(4),
+                                      cl::desc("Maximum number of times each function of a recursive SCC is analyzed by alias_lib_ipa"));
+
+static cl::opt<unsigned> AliasThreads("alias-threads", cl::init(0),
+                                      cl::desc("Number of threads used by alias_lib_parallel (0 for one per hardware thread)"));
+
+enum alias_output_format
+{
+  TEXT_OUTPUT, // One "pointer -> {aliases}" line per pointer, after the function name
+  JSON_OUTPUT // One JSON object per function
+};
+
+// It is assumed by default that the opt tool is run from the llvm-project/build/ folder
+static cl::opt<std::string> AliasOutputDir("alias-output-dir", cl::init("../assignment-3-may-alias-analysis-ArchitGanvir/output/"),
+                                           cl::desc("Directory in which the alias report of each module is written, as <module name>.txt or .jsonl"));
+
+static cl::opt<std::string> AliasOutput("alias-output", cl::init(""),
+                                        cl::desc("File to write the alias report to, instead of a file in -alias-output-dir ('-' for the standard output)"));
+
+static cl::opt<alias_output_format> AliasOutputFormat("alias-output-format", cl::init(TEXT_OUTPUT), cl::desc("Format of the alias report"),
+                                                      cl::values(clEnumValN(TEXT_OUTPUT, "text", "Text report (default)"),
+                                                                 clEnumValN(JSON_OUTPUT, "jsonl", "One JSON object per line and function")));
+
+static cl::opt<std::string> AliasCacheDir("alias-cache-dir", cl::init(""),
+                                          cl::desc("Directory of the persistent cache of per-function alias maps (disabled if empty)"));
+
+static cl::opt<bool> AliasPrintWork("alias-print-work", cl::init(false),
+                                    cl::desc("Print the fixpoint counters of the analysis as a JSON object to the standard error"));
+
+static cl::opt<std::string> AliasTrace("alias-trace", cl::init(""),
+                                       cl::desc("Write a Chrome trace of the time and fixpoint counters of each analyzed function to this file"));
+
+static cl::opt<bool> AliasEcho("alias-echo", cl::init(true), cl::desc("Echo the text alias report to the standard error"));
+
 namespace {
-struct alias_c : public FunctionPass {
-  static char ID;
-  alias_c() : FunctionPass(ID) {}
+// A set of locations in a function summary
+// Formal parameter indices stand for the objects which the actual arguments point to, and the other locations are qualified by the name of the function they belong to
+struct summary_set
+{
+  std::set<unsigned> params;
+  std::set<std::string> locations;
+
+  bool operator==(const summary_set &other) const
+  {
+    return params == other.params && locations == other.locations;
+  }
+
+  void merge(const summary_set &other)
+  {
+    params.insert(other.params.begin(), other.params.end());
+    locations.insert(other.locations.begin(), other.locations.end());
+  }
+};
+
+// Points-to summary of a function, in terms of its pointer parameters
+struct function_summary
+{
+  summary_set ret;  // What the return value may point to
+  std::map<unsigned, summary_set> pointees; // Parameter index -> what may be stored into the object the parameter points to
+
+  bool operator==(const function_summary &other) const
+  {
+    return ret == other.ret && pointees == other.pointees;
+  }
+
+  void merge(const function_summary &other)
+  {
+    ret.merge(other.ret);
+
+    for (auto &pair : other.pointees)
+    {
+      pointees[pair.first].merge(pair.second);
+    }
+  }
+};
+
+// Limits on the work of the analysis of a function; an analysis which goes over them gives up, so that the function can be analyzed by a cheaper one
+// The worklist pops are counted by the analysis, and the time from the creation of the budget
+class analysis_budget
+{
+public:
+  // An unlimited budget
+  analysis_budget() = default;
+
+  analysis_budget(uint64_t max_worklist_pops, unsigned max_milliseconds) : max_worklist_pops(max_worklist_pops)
+  {
+    if (max_milliseconds)
+    {
+      deadline = clock::now() + std::chrono::milliseconds(max_milliseconds);
+    }
+  }
+
+  // Checks if an analysis which has popped its worklist the given number of times is over the budget
+  bool isExceeded(uint64_t worklist_pops)
+  {
+    if (max_worklist_pops && worklist_pops > max_worklist_pops)
+    {
+      return true;
+    }
+
+    if (deadline != clock::time_point::max() && clock::now() > deadline)
+    {
+      timed_out = true;
+    }
+
+    return timed_out;
+  }
+
+  // Checks if the time ran out
+  bool hasTimedOut() const
+  {
+    return timed_out;
+  }
+
+private:
+  typedef std::chrono::steady_clock clock;
+
+  uint64_t max_worklist_pops = 0;
+  clock::time_point deadline = clock::time_point::max();
+  bool timed_out = false;
+};
+
+// Inclusion-based (Andersen-style) points-to constraint solver
+// Cycles of copy edges are detected lazily (when an edge is found to connect two nodes with equal points-to sets) and collapsed into a single node,
+// and each node only propagates the locations added to its points-to set since it was last processed (difference propagation)
+class andersen_solver
+{
+public:
+  // Nodes are numbered [0, num_nodes); only the nodes [0, num_pointers) have contents which can be loaded from or stored into
+  andersen_solver(int num_nodes, int num_pointers) : num_pointers(num_pointers), parent(num_nodes), points_to(num_nodes), delta(num_nodes), copy_edges(num_nodes),
+                                                     loads(num_nodes), stores(num_nodes), store_addresses(num_nodes), queued(num_nodes)
+  {
+    for (int node = 0; node < num_nodes; node++)
+    {
+      parent[node] = node;
+    }
+  }
+
+  // dst ⊇ {location}
+  void addAddressOf(int dst, int location)
+  {
+    addLocations(find(dst), SparseBitVector<>(), location);
+  }
+
+  // dst ⊇ src
+  void addCopy(int dst, int src)
+  {
+    addCopyEdge(find(src), find(dst));
+  }
+
+  // dst ⊇ *src
+  void addLoad(int dst, int src)
+  {
+    loads[find(src)].push_back(dst);
+    enqueueAll(find(src));
+  }
+
+  // *dst ⊇ src
+  void addStore(int dst, int src)
+  {
+    stores[find(dst)].push_back(src);
+    enqueueAll(find(dst));
+  }
+
+  // *dst ⊇ {location}
+  void addStoreAddress(int dst, int location)
+  {
+    store_addresses[find(dst)].push_back(location);
+    enqueueAll(find(dst));
+  }
+
+  // Propagates the points-to sets until every constraint is satisfied, returning false if the budget runs out first
+  bool solve(analysis_budget &budget)
+  {
+    int node, location;
+    SparseBitVector<> new_locations;
+    std::vector<int> node_loads, node_stores, node_store_addresses, succs;
+
+    while (!worklist.empty())
+    {
+      node = worklist.front();
+      worklist.pop_front();
+      queued.reset(node);
+      iterations++;
+
+      if (budget.isExceeded(iterations))
+      {
+        return false;
+      }
+
+      if (find(node) != node)  // The node has been collapsed into another one
+      {
+        continue;
+      }
+
+      new_locations = delta[node];
+      delta[node].clear();
+
+      // Resolving the complex constraints for the newly added locations
+      // The constraint lists are copied, since adding an edge may collapse a cycle and move them to another node
+
+      node_loads = loads[node];
+      node_stores = stores[node];
+      node_store_addresses = store_addresses[node];
+
+      for (unsigned pointee : new_locations)
+      {
+        if ((int)pointee >= num_pointers || find(node) != node)
+        {
+          continue;
+        }
+
+        location = find(pointee);
+
+        for (int dst : node_loads)
+        {
+          addCopyEdge(location, find(dst));
+        }
+
+        for (int src : node_stores)
+        {
+          addCopyEdge(find(src), location);
+        }
+
+        for (int address : node_store_addresses)
+        {
+          addLocations(find(pointee), SparseBitVector<>(), address);
+        }
+      }
+
+      // Propagating the newly added locations along the copy edges
+
+      succs.clear();
+
+      for (unsigned succ : copy_edges[node])  // The edges are copied, since collapsing a cycle modifies them
+      {
+        succs.push_back(succ);
+      }
+
+      for (int succ : succs)
+      {
+        if (find(node) != node)  // The node was collapsed into a cycle while propagating
+        {
+          break;
+        }
+
+        propagate(node, find(succ), new_locations);
+      }
+    }
+
+    return true;
+  }
+
+  // Returns the locations which the node may point to
+  const SparseBitVector<> &getPointsTo(int node)
+  {
+    return points_to[find(node)];
+  }
+
+  // Returns the number of nodes taken from the worklist
+  uint64_t getIterations() const
+  {
+    return iterations;
+  }
+
+  // Returns the number of times that locations were propagated along a copy edge
+  uint64_t getMeets() const
+  {
+    return meets;
+  }
+
+private:
+  int num_pointers;
+  uint64_t iterations = 0, meets = 0;
+  std::vector<int> parent;  // Union-find forest of the collapsed nodes
+  std::vector<SparseBitVector<>> points_to, delta;  // Points-to set of each node, and the locations not yet propagated from it
+  std::vector<SparseBitVector<>> copy_edges;  // Node -> nodes whose points-to sets include its points-to set
+  std::vector<std::vector<int>> loads, stores, store_addresses; // Complex constraints, indexed by the node which is dereferenced
+  std::set<std::pair<int, int>> checked_edges;  // Edges which have already triggered cycle detection
+  std::deque<int> worklist;
+  BitVector queued;
+
+  // Returns the representative of the node, compressing the path to it
+  int find(int node)
+  {
+    while (parent[node] != node)
+    {
+      parent[node] = parent[parent[node]];
+      node = parent[node];
+    }
+
+    return node;
+  }
+
+  void enqueue(int node)
+  {
+    if (!queued.test(node))
+    {
+      queued.set(node);
+      worklist.push_back(node);
+    }
+  }
+
+  // Schedules the node to propagate its whole points-to set again
+  void enqueueAll(int node)
+  {
+    delta[node] |= points_to[node];
+
+    if (!delta[node].empty())
+    {
+      enqueue(node);
+    }
+  }
+
+  // Adds the locations (and the extra location, if it is not negative) to the points-to set of the node
+  bool addLocations(int node, const SparseBitVector<> &locations, int location)
+  {
+    SparseBitVector<> added = locations;
+
+    if (location >= 0)
+    {
+      added.set(location);
+    }
+
+    added.intersectWithComplement(points_to[node]);
+
+    if (added.empty())
+    {
+      return false;
+    }
+
+    points_to[node] |= added;
+    delta[node] |= added;
+    enqueue(node);
+
+    return true;
+  }
+
+  // Adds the edge src -> dst, propagating the whole points-to set of src if the edge is new
+  void addCopyEdge(int src, int dst)
+  {
+    if (src == dst || copy_edges[src].test(dst))
+    {
+      return;
+    }
+
+    copy_edges[src].set(dst);
+
+    propagate(src, dst, points_to[src]);
+  }
+
+  // Propagates the locations along the edge src -> dst, and looks for a cycle through the edge when both ends end up with equal points-to sets
+  void propagate(int src, int dst, const SparseBitVector<> &locations)
+  {
+    if (src == dst)
+    {
+      return;
+    }
+
+    meets++;
+    addLocations(dst, locations, -1);
+
+    if (points_to[src] == points_to[dst] && !points_to[src].empty() && checked_edges.insert(std::make_pair(src, dst)).second)
+    {
+      collapseCycles(dst);
+    }
+  }
+
+  // Finds the cycles of copy edges reachable from the node (Tarjan's algorithm) and collapses each one into a single node
+  void collapseCycles(int root)
+  {
+    DenseMap<int, int> index, lowlink;
+    std::vector<int> stack, component;
+    std::vector<std::pair<int, std::vector<unsigned>>> call_stack;
+    BitVector on_stack(parent.size());
+    int next_index = 0, node, succ;
+
+    auto visit = [&](int node)
+    {
+      index[node] = lowlink[node] = next_index++;
+      stack.push_back(node);
+      on_stack.set(node);
+
+      std::vector<unsigned> succs;
+
+      for (unsigned succ : copy_edges[node])
+      {
+        succs.push_back(find(succ));
+      }
+
+      call_stack.push_back(std::make_pair(node, succs));
+    };
+
+    visit(root);
+
+    while (!call_stack.empty())
+    {
+      node = call_stack.back().first;
+
+      if (!call_stack.back().second.empty())
+      {
+        succ = call_stack.back().second.back();
+        call_stack.back().second.pop_back();
+
+        if (index.find(succ) == index.end())
+        {
+          visit(succ);
+        }
+        else if (on_stack.test(succ))
+        {
+          lowlink[node] = std::min(lowlink[node], index[succ]);
+        }
+
+        continue;
+      }
+
+      call_stack.pop_back();
+
+      if (!call_stack.empty())
+      {
+        lowlink[call_stack.back().first] = std::min(lowlink[call_stack.back().first], lowlink[node]);
+      }
+
+      if (lowlink[node] == index[node])
+      {
+        component.clear();
+
+        do
+        {
+          succ = stack.back();
+          stack.pop_back();
+          on_stack.reset(succ);
+          component.push_back(succ);
+        } while (succ != node);
+
+        if (component.size() > 1)
+        {
+          collapse(component);
+        }
+      }
+    }
+  }
+
+  // Merges the nodes into the first one
+  void collapse(const std::vector<int> &component)
+  {
+    int rep = component[0];
+
+    for (unsigned i = 1; i < component.size(); i++)
+    {
+      int node = component[i];
+
+      parent[node] = rep;
+
+      points_to[rep] |= points_to[node];
+      copy_edges[rep] |= copy_edges[node];
+      loads[rep].insert(loads[rep].end(), loads[node].begin(), loads[node].end());
+      stores[rep].insert(stores[rep].end(), stores[node].begin(), stores[node].end());
+      store_addresses[rep].insert(store_addresses[rep].end(), store_addresses[node].begin(), store_addresses[node].end());
+
+      points_to[node].clear();
+      delta[node].clear();
+      copy_edges[node].clear();
+      loads[node].clear();
+      stores[node].clear();
+      store_addresses[node].clear();
+    }
+
+    for (int node : component)
+    {
+      copy_edges[rep].reset(node);
+    }
+
+    enqueueAll(rep); // The successors of the merged nodes may not have seen all of the merged points-to set
+  }
+};
+
+// Unification-based (Steensgaard-style) points-to constraint solver
+// Every equivalence class of nodes points to at most one other class, and the constraints are solved by merging classes with a union-find forest,
+// in almost linear time
+class steensgaard_solver
+{
+public:
+  // Nodes are numbered [0, num_nodes); further nodes are created for the classes which are pointed to but have no node of their own
+  explicit steensgaard_solver(int num_nodes) : num_nodes(num_nodes), parent(num_nodes), rank(num_nodes, 0), pointee(num_nodes, -1)
+  {
+    for (int node = 0; node < num_nodes; node++)
+    {
+      parent[node] = node;
+    }
+  }
+
+  // dst ⊇ {location}
+  void addAddressOf(int dst, int location)
+  {
+    join(getPointee(dst), location);
+  }
+
+  // dst ⊇ src
+  void addCopy(int dst, int src)
+  {
+    join(getPointee(dst), getPointee(src));
+  }
+
+  // dst ⊇ *src
+  void addLoad(int dst, int src)
+  {
+    join(getPointee(dst), getPointee(getPointee(src)));
+  }
+
+  // *dst ⊇ src
+  void addStore(int dst, int src)
+  {
+    join(getPointee(getPointee(dst)), getPointee(src));
+  }
+
+  // *dst ⊇ {location}
+  void addStoreAddress(int dst, int location)
+  {
+    join(getPointee(getPointee(dst)), location);
+  }
+
+  // Groups the nodes by class, so that the points-to sets can be read off
+  // The constraints have already been solved as they were added, in almost linear time, so the budget is not checked
+  bool solve(analysis_budget &)
+  {
+    members.clear();
+
+    for (int node = 0; node < num_nodes; node++)
+    {
+      members[find(node)].set(node);
+    }
+
+    return true;
+  }
+
+  // Returns the nodes in the class which the node points to
+  const SparseBitVector<> &getPointsTo(int node)
+  {
+    static const SparseBitVector<> empty;
+    int rep = find(node);
+
+    if (pointee[rep] < 0)
+    {
+      return empty;
+    }
+
+    return members[find(pointee[rep])];
+  }
+
+  // Returns the representative of the class of the node
+  int getClass(int node)
+  {
+    return find(node);
+  }
+
+  // Returns the representative of the class which the node points to, or -1 if it points to nothing
+  int getPointeeClass(int node)
+  {
+    int rep = find(node);
+
+    return pointee[rep] < 0 ? -1 : find(pointee[rep]);
+  }
+
+  // Returns the number of pairs of classes which have been unified
+  uint64_t getIterations() const
+  {
+    return iterations;
+  }
+
+  // Unifying two classes is the meet of the analysis
+  uint64_t getMeets() const
+  {
+    return iterations;
+  }
+
+private:
+  int num_nodes;
+  uint64_t iterations = 0;
+  std::vector<int> parent, rank, pointee; // Union-find forest, and the class pointed to by each representative (-1 if none)
+  std::map<int, SparseBitVector<>> members;  // Representative -> original nodes in its class
+
+  // Returns the representative of the node, compressing the path to it
+  int find(int node)
+  {
+    while (parent[node] != node)
+    {
+      parent[node] = parent[parent[node]];
+      node = parent[node];
+    }
+
+    return node;
+  }
+
+  // Returns the representative of the class which the node points to, creating an empty class if there is none
+  int getPointee(int node)
+  {
+    int rep = find(node);
+
+    if (pointee[rep] < 0)
+    {
+      pointee[rep] = parent.size();
+      parent.push_back(parent.size());
+      rank.push_back(0);
+      pointee.push_back(-1);
+    }
+
+    return find(pointee[rep]);
+  }
+
+  // Merges the classes of the two nodes, and then (iteratively) the classes they point to
+  void join(int node1, int node2)
+  {
+    std::vector<std::pair<int, int>> pending{std::make_pair(node1, node2)};
+    int rep1, rep2, pointee1, pointee2;
+
+    while (!pending.empty())
+    {
+      rep1 = find(pending.back().first);
+      rep2 = find(pending.back().second);
+      pending.pop_back();
+      iterations++;
+
+      if (rep1 == rep2)
+      {
+        continue;
+      }
+
+      if (rank[rep1] < rank[rep2])
+      {
+        std::swap(rep1, rep2);
+      }
+
+      parent[rep2] = rep1;
+      rank[rep1] += rank[rep1] == rank[rep2];
+
+      pointee1 = pointee[rep1];
+      pointee2 = pointee[rep2];
+
+      if (pointee1 < 0)
+      {
+        pointee[rep1] = pointee2;
+      }
+      else if (pointee2 >= 0)
+      {
+        pending.push_back(std::make_pair(pointee1, pointee2));
+      }
+    }
+  }
+};
+
+// Demand-driven inclusion-based points-to solver
+// The constraints are only recorded up front; a query computes the points-to sets of its pointers and of the nodes they transitively depend on
+// (their copy and load sources, and, for a node with contents, the stores which may write into it), which is the CFL-reachability formulation of
+// the inclusion-based analysis restricted to the demanded part of the constraint graph
+// The stores which may write into a node are found through a unification-based solution of the same constraints, built as they are added: it
+// over-approximates the inclusion-based one, so only the stores through pointers whose unified points-to class holds the node are demanded
+// Points-to sets are kept across queries: a completed query leaves exact sets, while the nodes of one which runs out of budget are marked unresolved,
+// so that any later query reaching them gives up at once instead of spending its budget on the same nodes again
+class demand_solver
+{
+public:
+  // Nodes are numbered [0, num_nodes); only the nodes [0, num_pointers) have contents which can be loaded from or stored into
+  demand_solver(int num_nodes, int num_pointers, uint64_t budget) : num_pointers(num_pointers), budget(budget), addresses(num_nodes), copies(num_nodes),
+                                                                    loads(num_nodes), stores_through(num_nodes), writers(num_nodes), points_to(num_nodes),
+                                                                    addressed(num_nodes), complete(num_nodes), unresolved(num_nodes), unification(num_nodes) {}
+
+  // dst ⊇ {location}
+  void addAddressOf(int dst, int location)
+  {
+    addresses[dst].set(location);
+    addressed.set(location);
+    unification.addAddressOf(dst, location);
+  }
+
+  // dst ⊇ src
+  void addCopy(int dst, int src)
+  {
+    copies[dst].push_back(src);
+    unification.addCopy(dst, src);
+  }
+
+  // dst ⊇ *src
+  void addLoad(int dst, int src)
+  {
+    loads[dst].push_back(src);
+    unification.addLoad(dst, src);
+  }
+
+  // *dst ⊇ src
+  void addStore(int dst, int src)
+  {
+    addStoreConstraint(dst, src, false);
+    unification.addStore(dst, src);
+  }
+
+  // *dst ⊇ {location}
+  void addStoreAddress(int dst, int location)
+  {
+    addStoreConstraint(dst, location, true);
+    addressed.set(location);
+    unification.addStoreAddress(dst, location);
+  }
+
+  // Checks if the points-to sets of the two nodes may intersect; the answer is true if the query runs out of budget
+  bool mayAlias(int node1, int node2)
+  {
+    auto key = std::make_pair(std::min(node1, node2), std::max(node1, node2));
+    auto it = answers.find(key);
+
+    if (it != answers.end())
+    {
+      return it->second;
+    }
+
+    bool answer = !solve({node1, node2}) || points_to[node1].intersects(points_to[node2]);
+
+    answers[key] = answer;
+
+    return answer;
+  }
+
+  // Computes the points-to sets of the nodes, returning false if the budget runs out or an unresolved node is reached
+  bool solve(std::initializer_list<int> roots)
+  {
+    query_state query;
+
+    for (int root : roots)
+    {
+      demand(query, root);
+    }
+
+    while (!query.worklist.empty() && !query.failed)
+    {
+      int node = query.worklist.front();
+
+      query.worklist.pop_front();
+      query.queued.erase(node);
+      counters.worklist_pops++;
+
+      evaluate(query, node);
+      query.failed |= budget && query.steps > budget;
+    }
+
+    if (query.failed)
+    {
+      for (int node : query.demanded)
+      {
+        unresolved.set(node);
+      }
+
+      return false;
+    }
+
+    for (int node : query.demanded)
+    {
+      complete.set(node);
+    }
+
+    return true;
+  }
+
+  // Returns the points-to set of the node, which is exact if a query including the node has completed
+  const SparseBitVector<> &getPointsTo(int node) const
+  {
+    return points_to[node];
+  }
+
+  const fixpoint_counters &getCounters() const
+  {
+    return counters;
+  }
+
+private:
+  // *dst ⊇ value, or *dst ⊇ {value} for a store of an address
+  struct store_constraint
+  {
+    int dst, value;
+    bool address;
+    SparseBitVector<> indexed;  // Locations which the store has been added to the writers of
+  };
+
+  // The nodes of a query whose points-to sets are not yet exact
+  struct query_state
+  {
+    std::vector<int> demanded;
+    DenseSet<int> is_demanded, queued;
+    std::deque<int> worklist;
+    DenseMap<int, DenseSet<int>> dependents; // Node -> demanded nodes whose points-to sets were computed from it
+    DenseSet<int> store_classes;               // Unified classes whose writing stores have been demanded
+    uint64_t steps = 0;
+    bool failed = false;
+  };
+
+  int num_pointers;
+  uint64_t budget;
+  std::vector<SparseBitVector<>> addresses;
+  std::vector<std::vector<int>> copies, loads;  // Sources of the copy and load constraints of each node
+  std::vector<store_constraint> stores;
+  std::vector<int> store_pointers;  // Nodes which are stored through
+  DenseMap<int, std::vector<int>> class_store_pointers;  // Unified class -> nodes which are stored through and may point into it, built by the first query
+  std::vector<std::vector<int>> stores_through, writers; // Indices of the stores through each node, and of the stores which may write into each node
+  std::vector<SparseBitVector<>> points_to;
+  BitVector addressed;  // Nodes which some pointer may point to, and hence which some store may write into
+  BitVector complete; // Nodes whose points-to sets are exact
+  BitVector unresolved; // Nodes of queries which ran out of budget, whose points-to sets are only lower bounds
+  std::map<std::pair<int, int>, bool> answers;  // Memoized results of the queries
+  fixpoint_counters counters;
+  steensgaard_solver unification;  // Solved as the constraints are added
+
+  void addStoreConstraint(int dst, int value, bool address)
+  {
+    if (stores_through[dst].empty())
+    {
+      store_pointers.push_back(dst);
+    }
+
+    stores_through[dst].push_back(stores.size());
+    stores.push_back({dst, value, address, SparseBitVector<>()});
+  }
+
+  void demand(query_state &query, int node)
+  {
+    if (complete[node] || !query.is_demanded.insert(node).second)
+    {
+      return;
+    }
+
+    if (unresolved[node])
+    {
+      query.failed = true;
+    }
+
+    query.demanded.push_back(node);
+    enqueue(query, node);
+  }
+
+  // Demands the pointers which are stored through and may point to the node, according to the unification-based solution, since their stores
+  // may write into the node
+  void demandStores(query_state &query, int node)
+  {
+    int node_class = unification.getClass(node);
+
+    if (!query.store_classes.insert(node_class).second)
+    {
+      return;
+    }
+
+    if (class_store_pointers.empty())
+    {
+      for (int ptr : store_pointers)
+      {
+        int pointee_class = unification.getPointeeClass(ptr);
+
+        if (pointee_class >= 0)  // Otherwise the pointer points to nothing, and its stores write nothing
+        {
+          class_store_pointers[pointee_class].push_back(ptr);
+        }
+      }
+    }
+
+    auto it = class_store_pointers.find(node_class);
+
+    if (it == class_store_pointers.end())
+    {
+      return;
+    }
+
+    query.steps += it->second.size();
+
+    for (int ptr : it->second)
+    {
+      demand(query, ptr);
+    }
+  }
+
+  void enqueue(query_state &query, int node)
+  {
+    if (query.queued.insert(node).second)
+    {
+      query.worklist.push_back(node);
+    }
+  }
+
+  // Returns the points-to set of the source, recording that the node depends on it
+  const SparseBitVector<> &read(query_state &query, int source, int node)
+  {
+    query.steps++;
+
+    if (!complete[source])
+    {
+      demand(query, source);
+      query.dependents[source].insert(node);
+    }
+
+    return points_to[source];
+  }
+
+  // Adds the locations to the points-to set of the node
+  bool meet(int node, const SparseBitVector<> &locations)
+  {
+    counters.meets++;
+
+    return points_to[node] |= locations;
+  }
+
+  // Adds the stores through the pointer to the writers of the locations newly in its points-to set, and re-evaluates those locations
+  void indexStores(query_state &query, int ptr)
+  {
+    for (int index : stores_through[ptr])
+    {
+      store_constraint &store = stores[index];
+      SparseBitVector<> locations = points_to[ptr];
+
+      locations.intersectWithComplement(store.indexed);
+
+      if (locations.empty())
+      {
+        continue;
+      }
+
+      store.indexed |= locations;
+
+      for (unsigned location : locations)
+      {
+        query.steps++;
+
+        if ((int)location < num_pointers)
+        {
+          writers[location].push_back(index);
+
+          if (query.is_demanded.count(location))
+          {
+            enqueue(query, location);
+          }
+        }
+      }
+    }
+  }
+
+  // Recomputes the points-to set of the node from its constraints
+  void evaluate(query_state &query, int node)
+  {
+    bool changed = meet(node, addresses[node]);
+
+    counters.transfers++;
+
+    for (int src : copies[node])
+    {
+      changed |= meet(node, read(query, src, node));
+    }
+
+    for (int src : loads[node])
+    {
+      SparseBitVector<> pointees = read(query, src, node);  // Copied, since reading the pointees may add to it
+
+      for (unsigned pointee : pointees)
+      {
+        if ((int)pointee < num_pointers)
+        {
+          changed |= meet(node, read(query, pointee, node));
+        }
+      }
+    }
+
+    if (node < num_pointers && addressed[node]) // The contents of the node may be written by the stores through the pointers which may point to it
+    {
+      demandStores(query, node);
+
+      for (int index : writers[node])
+      {
+        const store_constraint &store = stores[index];
+
+        if (store.address)
+        {
+          changed |= !points_to[node].test(store.value);
+          points_to[node].set(store.value);
+        }
+        else
+        {
+          changed |= meet(node, read(query, store.value, node));
+        }
+      }
+    }
+
+    if (changed)
+    {
+      for (int dependent : query.dependents[node])
+      {
+        enqueue(query, dependent);
+      }
+    }
+
+    indexStores(query, node);
+  }
+};
+
+typedef std::vector<std::pair<std::string, std::set<std::string>>> alias_map_t;
+
+// A table of immutable points-to sets, hash-consed so that equal sets are stored once and shared by every program point holding them
+// Sets are held through reference-counted handles, and a set is freed when its last handle goes away; handles are compared by identity
+// The table is not thread-safe, and must outlive its handles
+class points_to_set_table
+{
+  struct entry
+  {
+    BitVector bits;
+    unsigned hash;
+    unsigned references = 0;
+    points_to_set_table *table;
+  };
+
+public:
+  class handle
+  {
+  public:
+    handle() = default;
+
+    handle(const handle &other) : set(other.set)
+    {
+      retain();
+    }
+
+    handle &operator=(handle other)
+    {
+      std::swap(set, other.set);
+
+      return *this;
+    }
+
+    ~handle()
+    {
+      if (set && --set->references == 0)
+      {
+        set->table->erase(set);
+      }
+    }
+
+    const BitVector &operator*() const
+    {
+      return set->bits;
+    }
+
+    const BitVector *operator->() const
+    {
+      return &set->bits;
+    }
+
+    bool operator==(const handle &other) const
+    {
+      return set == other.set;
+    }
+
+    bool operator!=(const handle &other) const
+    {
+      return set != other.set;
+    }
+
+  private:
+    friend class points_to_set_table;
+
+    entry *set = nullptr;
+
+    explicit handle(entry *set) : set(set)
+    {
+      retain();
+    }
+
+    void retain()
+    {
+      if (set)
+      {
+        set->references++;
+      }
+    }
+  };
+
+  points_to_set_table() = default;
+  points_to_set_table(const points_to_set_table &) = delete;
+  points_to_set_table &operator=(const points_to_set_table &) = delete;
+
+  // Returns the handle of the set equal to the bitvector, adding it to the table if there is none
+  handle get(const BitVector &bits)
+  {
+    unsigned hash = bits.empty() ? 0 : DenseMapInfo<BitVector>::getHashValue(bits);  // Bitvectors of no bits cannot be hashed by DenseMapInfo
+    auto range = sets.equal_range(hash);
+
+    for (auto it = range.first; it != range.second; ++it)
+    {
+      if (it->second->bits == bits)
+      {
+        return handle(it->second);
+      }
+    }
+
+    entry *set = new entry{bits, hash, 0, this};
+
+    sets.emplace(hash, set);
+
+    return handle(set);
+  }
+
+  // Returns the handle of the set with just the location, out of num_locations
+  handle getSingleton(unsigned num_locations, int location)
+  {
+    BitVector bits(num_locations);
+
+    bits.set(location);
+
+    return get(bits);
+  }
+
+  // Returns the handle of the union of the set and the locations
+  handle getUnion(const handle &set, const BitVector &locations)
+  {
+    BitVector bits = *set;
+
+    bits |= locations;
+
+    return bits == *set ? set : get(bits);
+  }
+
+  handle getUnion(const handle &set1, const handle &set2)
+  {
+    return set1 == set2 ? set1 : getUnion(set1, *set2);
+  }
+
+  // Returns the handle of the set with the location added
+  handle getWith(const handle &set, int location)
+  {
+    if (set->test(location))
+    {
+      return set;
+    }
+
+    BitVector bits = *set;
+
+    bits.set(location);
+
+    return get(bits);
+  }
+
+  // Returns the number of distinct sets held
+  size_t size() const
+  {
+    return sets.size();
+  }
+
+private:
+  std::unordered_multimap<unsigned, entry *> sets;  // Hash -> sets with that hash
+
+  void erase(entry *set)
+  {
+    auto range = sets.equal_range(set->hash);
+
+    for (auto it = range.first; it != range.second; ++it)
+    {
+      if (it->second == set)
+      {
+        sets.erase(it);
+        break;
+      }
+    }
+
+    delete set;
+  }
+};
+
+// Flow-sensitive may-points-to analysis of a single function
+class points_to_analysis
+{
+public:
+  // A points-to map, indexed by interned pointer ID; each points-to set is a handle to a shared bitvector over the interned location IDs
+  // Copying a map only copies the handles, and two maps are equal if they hold the same handles
+  typedef std::vector<points_to_set_table::handle> points_to_map;
+
+  // When summaries are given, calls to the summarized functions are modelled using them, and the formal parameters are tracked so that the function itself can be summarized
+  explicit points_to_analysis(const std::map<Function *, function_summary> *summaries = nullptr) : summaries(summaries) {}
+
+  // Performs the flow-sensitive may-alias analysis of the function
+  void run(Function &F)
+  {
+    analysis_budget unlimited;
+
+    run(F, unlimited);
+  }
+
+  // Performs the flow-sensitive may-alias analysis of the function, returning false (with no alias_map) if the budget runs out first
+  bool run(Function &F, analysis_budget &budget)
+  {
+    prepare(F);
+
+    // Only the IN and OUT maps of the basic blocks are stored; the maps at the other program points are recomputed on demand
+
+    block_in.assign(blocks.size(), initial_points_to_map);
+    block_out.assign(blocks.size(), initial_points_to_map);
+
+    rpo_worklist worklist(F);
+
+    worklist.pushAll(); // Adding all the basic blocks to the worklist
+
+    if (!propagate(worklist, budget))
+    {
+      return false;
+    }
+
+    calculateFinalAliasMap();
+
+    return true;
+  }
+
+  // Brings the flow-sensitive results up to date with the changes made to the function since the last update, re-propagating only from the basic blocks which changed
+  // The maps of the other basic blocks are carried over to the new IDs, so the result is a fixpoint of the changed function, though one which may be less precise
+  // than a fresh run when an edit removes a flow around a loop
+  // The first update of a function performs the full analysis
+  void update(Function &F)
+  {
+    if (snapshot_blocks.empty())
+    {
+      run(F);
+      takeSnapshot();
+
+      return;
+    }
+
+    analysis_budget unlimited;
+    std::vector<WeakVH> old_values, old_blocks;
+    std::vector<hash_code> old_hashes;
+    std::vector<field_info> old_fields = fields;
+    std::vector<std::string> old_foreign_names = foreign_names;
+    std::vector<points_to_map> old_in, old_out;
+    points_to_map old_ssa_points_to;
+    int old_num_cells = num_cells, old_num_pointers = num_pointers;
+
+    old_values.swap(snapshot_values);
+    old_blocks.swap(snapshot_blocks);
+    old_hashes.swap(snapshot_hashes);
+    old_in.swap(block_in);
+    old_out.swap(block_out);
+    old_ssa_points_to.swap(ssa_points_to);
+
+    prepare(F);
+
+    // Translating the old IDs to the new ones; the values deleted since have no new ID
+
+    DenseMap<BasicBlock *, int> old_block_numbers;
+    DenseMap<const BitVector *, points_to_set_table::handle> translated;
+    std::vector<int> new_ids(old_values.size(), -1);
+
+    for (int id = 0; id < (int)old_values.size(); id++)
+    {
+      auto it = ids.find(old_values[id]);
+      auto object = object_fields.find(old_values[id]);
+
+      if (!old_foreign_names[id].empty() && foreign_ids.count(old_foreign_names[id]))
+      {
+        new_ids[id] = foreign_ids[old_foreign_names[id]];
+      }
+      else if (!old_values[id])
+      {
+        continue;
+      }
+      else if (old_fields[id].index < 0 && it != ids.end())
+      {
+        new_ids[id] = it->second;
+      }
+      else if (old_fields[id].index >= 0 && object != object_fields.end() && old_fields[id].index < (int)object->second.size())
+      {
+        new_ids[id] = object->second[old_fields[id].index];
+      }
+    }
+
+    for (int id = old_num_cells; id < old_num_pointers; id++)
+    {
+      if (new_ids[id] >= num_cells && new_ids[id] < num_pointers)
+      {
+        ssa_points_to[new_ids[id] - num_cells] = translateSet(old_ssa_points_to[id - old_num_cells], new_ids, translated);
+      }
+    }
+
+    // Carrying over the maps of the basic blocks which still exist, and re-propagating from the ones which are new or whose instructions or predecessors changed
+
+    for (int i = 0; i < (int)old_blocks.size(); i++)
+    {
+      if (old_blocks[i])
+      {
+        old_block_numbers[cast<BasicBlock>(old_blocks[i])] = i;
+      }
+    }
+
+    block_in.assign(blocks.size(), initial_points_to_map);
+    block_out.assign(blocks.size(), initial_points_to_map);
+
+    rpo_worklist worklist(F);
+
+    for (int i = 0; i < (int)blocks.size(); i++)
+    {
+      auto it = old_block_numbers.find(blocks[i]);
+
+      if (it != old_block_numbers.end())
+      {
+        block_in[i] = translateMap(old_in[it->second], old_num_cells, new_ids, translated);
+        block_out[i] = translateMap(old_out[it->second], old_num_cells, new_ids, translated);
+      }
+
+      if (it == old_block_numbers.end() || old_hashes[it->second] != hashBlock(i))
+      {
+        worklist.push(blocks[i]);
+      }
+    }
+
+    propagate(worklist, unlimited);
+    calculateFinalAliasMap();
+    takeSnapshot();
+  }
+
+  // Performs the flow-insensitive, inclusion-based (Andersen-style) may-alias analysis of the function
+  // Returns false (with no alias_map) if the budget runs out first
+  bool runAndersen(Function &F, analysis_budget &budget)
+  {
+    prepare(F);
+
+    andersen_solver solver(values.size(), num_pointers);
+
+    return runFlowInsensitive(solver, budget);
+  }
+
+  // Performs the flow-insensitive, unification-based (Steensgaard-style) may-alias analysis of the function
+  void runSteensgaard(Function &F)
+  {
+    analysis_budget unlimited;
+
+    prepare(F);
+
+    steensgaard_solver solver(values.size());
+
+    runFlowInsensitive(solver, unlimited);
+  }
+
+  // Performs the inclusion-based may-alias analysis of the function on demand, answering one query per pair of reported pointers
+  // The solver is kept, so that mayAlias can be asked about other pairs afterwards
+  void runDemand(Function &F)
+  {
+    std::set<std::string> aliases;
+
+    prepare(F);
+
+    demand = std::make_unique<demand_solver>(values.size(), num_pointers, AliasQueryBudget);
+
+    for (int ptr = 0; ptr < num_cells; ptr++)
+    {
+      for (int location : initial_points_to_map[ptr]->set_bits())
+      {
+        demand->addAddressOf(ptr, location);
+      }
+    }
+
+    for (const instruction_info &info : instruction_infos)
+    {
+      addConstraints(info, *demand);
+    }
+
+    for (int ptr : reported_ids)
+    {
+      aliases.clear();
+
+      for (int other_ptr : reported_ids)
+      {
+        if (other_ptr != ptr && demand->mayAlias(ptr, other_ptr))
+        {
+          aliases.insert(getName(other_ptr));
+        }
+      }
+
+      alias_map.push_back(std::make_pair(getName(ptr), aliases));
+    }
+
+    counters += demand->getCounters();
+    counters.transfers += instruction_infos.size();
+
+    for (int ptr = 0; ptr < num_pointers; ptr++)
+    {
+      counters.lattice_size += demand->getPointsTo(ptr).count();
+    }
+  }
+
+  // Checks if the two values may point to the same location, after runDemand
+  // A location (such as an alloca) points to itself; a value which is not tracked, or a query which runs out of budget, is assumed to alias
+  bool mayAlias(const Value *V1, const Value *V2)
+  {
+    auto it1 = ids.find(V1), it2 = ids.find(V2);
+
+    if (!demand || it1 == ids.end() || it2 == ids.end())
+    {
+      return true;
+    }
+
+    int id1 = it1->second, id2 = it2->second;
+
+    if (named[id1] && named[id2])
+    {
+      return id1 == id2;
+    }
+
+    if (named[id1] || named[id2])  // Checking if the pointer may point to the location
+    {
+      int ptr = named[id1] ? id2 : id1, location = named[id1] ? id1 : id2;
+
+      return !demand->solve({ptr}) || demand->getPointsTo(ptr).test(location);
+    }
+
+    return demand->mayAlias(id1, id2);
+  }
+
+  // Returns the pointers which may alias each pointer at the last program point of the function
+  const alias_map_t &getAliasMap() const
+  {
+    return alias_map;
+  }
+
+  // Returns the work done by the analyses run so far
+  const fixpoint_counters &getCounters() const
+  {
+    return counters;
+  }
+
+  // Summarizes what the return value of the function may point to, and what may be stored into the objects which its pointer parameters point to
+  function_summary getSummary(Function &F)
+  {
+    function_summary summary;
+    points_to_map map;
+    int ret;
+
+    for (int i = 0; i < (int)instructions.size(); i++)
+    {
+      if (ReturnInst *RI = dyn_cast<ReturnInst>(instructions[i]))
+      {
+        map = getOutMap(i);
+
+        if (RI->getReturnValue() && isTrackedPointer(RI->getReturnValue()))
+        {
+          ret = getID(RI->getReturnValue());
+
+          if (named[ret])
+          {
+            addToSummary(F, ret, summary.ret);
+          }
+          else if (isPointer(ret))
+          {
+            for (int location : getPointsTo(map, ret)->set_bits())
+            {
+              addToSummary(F, location, summary.ret);
+            }
+          }
+        }
+
+        for (auto &pair : param_ids)
+        {
+          for (int location : map[pair.first]->set_bits())
+          {
+            addToSummary(F, location, summary.pointees[pair.second]);
+          }
+        }
+      }
+    }
+
+    return summary;
+  }
+
+  // A range of bytes [begin, end) of a value, any of which a pointer may point to
+  struct byte_range
+  {
+    const Value *object;
+    uint64_t begin, end;
+  };
+
+  // Adds to pointees the values which the pointer defined by the given load or getelementptr may point to just after its definition, after run
+  // Returns false if the value is not a tracked pointer or may point to a location that is not a value of the function or module (such as null)
+  bool getPointees(const Value *V, SmallVectorImpl<const Value *> &pointees)
+  {
+    SmallVector<byte_range, 4> ranges;
+
+    if (!getPointeeRanges(V, ranges))
+    {
+      return false;
+    }
+
+    for (const byte_range &range : ranges)
+    {
+      pointees.push_back(range.object);
+    }
+
+    return true;
+  }
+
+  // Checks if the points-to maps describe the pointers stored into the alloca: a pointer variable, or a struct or array with fields holding pointers
+  static bool isCell(const AllocaInst &AI)
+  {
+    Type *T = AI.getAllocatedType();
+
+    return T->isPointerTy() || (AliasMaxFields && (T->isStructTy() || T->isArrayTy()) && containsPointer(T));
+  }
+
+  // Like getPointees, but adds the bytes of the values which the pointer may point to: the start of a field of a struct or array alloca (or any byte of a
+  // merged field), and any byte of any other location
+  bool getPointeeRanges(const Value *V, SmallVectorImpl<byte_range> &ranges)
+  {
+    auto it = ids.find(V);
+
+    if (it == ids.end() || (!isa<LoadInst>(V) && !isa<GetElementPtrInst>(V)))
+    {
+      return false;
+    }
+
+    points_to_map map = getOutMap(instruction_numbers[cast<Instruction>(const_cast<Value *>(V))]);
+
+    for (int location : getPointsTo(map, it->second)->set_bits())
+    {
+      if (!values[location])
+      {
+        return false;
+      }
+
+      if (fields[location].index >= 0) // A pointer to a field points to its start, unless the field is merged
+      {
+        ranges.push_back({values[location], fields[location].begin, fields[location].merged ? fields[location].end : fields[location].begin + 1});
+      }
+      else
+      {
+        ranges.push_back({values[location], 0, UINT64_MAX});
+      }
+    }
+
+    return true;
+  }
+
+private:
+  // The pointers and locations read and written by an instruction, resolved to interned IDs once per function
+  struct instruction_info
+  {
+    unsigned opcode = 0;  // 0 if the instruction does not affect the points-to map
+    int ptr1 = -1, ptr2 = -1;
+    int call_site = -1; // Index into call_sites, for calls to summarized functions
+    std::vector<int> sources; // Pointers which a phi, select or cast copies
+    std::vector<int64_t> offsets; // Byte offsets which a getelementptr may add to its base, when they are known
+    bool offsets_known = false;
+  };
+
+  // A field of a struct or array alloca, covering the bytes [begin, end) of it (including the padding after it)
+  // When an object has more fields than the cap, its last field covers all the rest
+  struct field_info
+  {
+    int index = -1; // Index of the field within its object, or -1 if the ID is not a field
+    uint64_t begin = 0, end = 0;
+    bool merged = false;  // Whether the field stands for several fields, so that stores into it are weak
+    bool holds_pointers = false;  // Whether the field may hold a pointer, so that it is a cell of the points-to maps
+    std::string name; // Suffix naming the field within its object, such as "[2]" or ".1"
+  };
+
+  // A summary set resolved to the interned IDs of the caller
+  struct resolved_set
+  {
+    std::vector<unsigned> params;
+    std::vector<int> locations;
+  };
+
+  // The summary of the called function, resolved at a call site
+  struct call_site_info
+  {
+    std::vector<int> args; // IDs of the actual arguments, -1 for non-pointer arguments
+    resolved_set ret;
+    std::vector<std::pair<unsigned, resolved_set>> pointees;
+  };
+
+  const std::map<Function *, function_summary> *summaries;
+  fixpoint_counters counters;
+
+  Function *function;
+  DenseMap<const Value *, int> ids;  // Value -> ID
+  std::unordered_map<std::string, int> foreign_ids;  // Location of another function, taken from its summary -> ID
+  std::vector<const Value *> values; // ID -> value (the array itself for the first element of an array), or nullptr for a location of another function
+  std::vector<std::string> foreign_names; // ID -> name of the location of another function, or empty
+  std::vector<bool> named;  // ID -> whether the value is a location (an alloca, argument, global or unsummarized call), rather than a pointer value
+  std::vector<bool> foreign;  // ID -> whether the ID is a location of another function, taken from its summary
+  std::vector<field_info> fields; // ID -> the field of a struct or array alloca which the ID is, if any (with AliasMaxFields = 0, the first element of an array)
+  DenseMap<const Value *, std::vector<int>> object_fields;  // Struct or array alloca -> IDs of its fields, in order of their offsets
+  int num_pointers; // Pointers occupy the IDs [0, num_pointers)
+  int num_cells;  // Pointers whose points-to sets vary between program points (the keys of the points-to map) occupy the IDs [0, num_cells)
+  std::vector<int> reported_ids;  // IDs of the pointers and arrays which are the keys of alias_map
+  std::map<int, unsigned> param_ids;  // ID of the object pointed to by a pointer parameter -> parameter index
+
+  std::vector<Instruction *> instructions;  // Instruction number -> instruction
+  DenseMap<Instruction *, int> instruction_numbers;  // Instruction -> instruction number
+  std::vector<BasicBlock *> blocks; // Basic block number -> basic block
+  DenseMap<BasicBlock *, int> block_numbers;  // Basic block -> basic block number
+  std::vector<int> instruction_blocks, block_start, block_end; // Basic block number of each instruction, and the numbers of the first and last instructions of each basic block
+  std::vector<std::vector<int>> predecessors, successors;  // Predecessor and successor basic block numbers of each basic block
+
+  std::vector<instruction_info> instruction_infos;  // Instruction number -> resolved operands
+  std::vector<call_site_info> call_sites;
+  points_to_set_table sets;  // The points-to sets held by the maps below, so it is declared before them
+  points_to_map ssa_points_to;  // Points-to set of each SSA pointer, with IDs [num_cells, num_pointers), which holds at every program point
+  std::vector<std::vector<int>> ssa_users;  // SSA pointer -> basic blocks with instructions which read it
+  std::vector<int> stale_blocks; // Basic blocks reading an SSA pointer whose points-to set has grown since they were last transferred
+  points_to_map initial_points_to_map;
+  std::vector<points_to_map> block_in, block_out; // IN and OUT maps of each basic block
+  std::unique_ptr<demand_solver> demand;  // The constraints and memoized queries of runDemand
+  std::vector<WeakVH> snapshot_values, snapshot_blocks;  // ID -> value, and basic block number -> basic block, at the last update
+  std::vector<hash_code> snapshot_hashes;  // Basic block number -> hash of the basic block at the last update
+
+  alias_map_t alias_map;
+
+  // Checks if the value is a location which the pointers can point to, rather than a pointer value which is copied when stored
+  bool isLocation(const Value *V)
+  {
+    if (isa<AllocaInst>(V) || isa<Argument>(V) || isa<GlobalValue>(V))
+    {
+      return true;
+    }
+
+    if (const CallInst *CI = dyn_cast<CallInst>(V)) // The result of a call is a fresh object, unless the called function is summarized
+    {
+      return !getCalleeSummary(*const_cast<CallInst *>(CI));
+    }
+
+    return false;
+  }
+
+  // Adds a new ID
+  int addID(const Value *V, bool is_named, bool is_foreign)
+  {
+    values.push_back(V);
+    foreign_names.emplace_back();
+    named.push_back(is_named);
+    foreign.push_back(is_foreign);
+    fields.emplace_back();
+
+    return values.size() - 1;
+  }
+
+  // Returns the ID of the value, interning it if it has not been seen before
+  int getID(const Value *V)
+  {
+    auto it = ids.find(V);
+
+    if (it != ids.end())
+    {
+      return it->second;
+    }
+
+    int id = addID(V, isLocation(V), false);
+
+    ids[V] = id;
+
+    return id;
+  }
+
+  // Returns the ID of the value as an address: that of the first field for a struct or array alloca which is split into fields
+  int getAddressID(const Value *V)
+  {
+    auto it = AliasMaxFields ? object_fields.find(V) : object_fields.end();
+
+    return it != object_fields.end() ? it->second.front() : getID(V);
+  }
+
+  // Returns the ID of the location of another function, taken from its summary (globals are shared with this function)
+  int getForeignID(const std::string &name)
+  {
+    if (GlobalValue *GV = function->getParent()->getNamedValue(name))
+    {
+      return getID(GV);
+    }
+
+    auto it = foreign_ids.find(name);
+
+    if (it != foreign_ids.end())
+    {
+      return it->second;
+    }
+
+    int id = addID(nullptr, true, true);
+
+    foreign_ids[name] = id;
+    foreign_names[id] = name;
+
+    return id;
+  }
+
+  // Checks if the given ID is a pointer, whose points-to set is tracked
+  bool isPointer(int id)
+  {
+    return id >= 0 && id < num_pointers;
+  }
+
+  // Checks if the instruction defines an SSA pointer when the function is in SSA form
+  bool isSSAPointer(Instruction &I)
+  {
+    if (!I.getType()->isPointerTy())
+    {
+      return false;
+    }
+
+    return isa<LoadInst>(&I) || isa<GetElementPtrInst>(&I) || isa<PHINode>(&I) || isa<SelectInst>(&I) || isa<CastInst>(&I) || getCalleeSummary(I);
+  }
+
+  // Returns the pointers which the instruction reads
+  std::vector<int> getOperandPointers(const instruction_info &info)
+  {
+    std::vector<int> operands = info.sources;
+
+    if (info.opcode == Instruction::Store)
+    {
+      operands.push_back(info.ptr1);
+    }
+
+    if (info.opcode != Instruction::Call)
+    {
+      operands.push_back(info.ptr2);
+    }
+    else
+    {
+      operands.insert(operands.end(), call_sites[info.call_site].args.begin(), call_sites[info.call_site].args.end());
+    }
+
+    return operands;
+  }
+
+  // Returns the name of the ID, as it appears in the report and in summaries
+  std::string getName(int id)
+  {
+    std::string s;
+    raw_string_ostream rso(s);
+
+    if (foreign[id])
+    {
+      return foreign_names[id];
+    }
+
+    if (values[id]->hasName())
+    {
+      rso << values[id]->getName();
+    }
+    else
+    {
+      values[id]->printAsOperand(rso, false);
+    }
+
+    rso << fields[id].name;
+
+    return rso.str();
+  }
+
+  // Checks if the value is a pointer which may point to a named location (null and other constants point nowhere)
+  bool isTrackedPointer(Value *V)
+  {
+    return V->getType()->isPointerTy() && (!isa<Constant>(V) || isa<GlobalValue>(V));
+  }
+
+  // Returns the summary of the function called by the instruction, if there is one
+  const function_summary *getCalleeSummary(Instruction &I)
+  {
+    CallInst *CI = dyn_cast<CallInst>(&I);
+
+    if (!summaries || !CI || !CI->getCalledFunction())
+    {
+      return nullptr;
+    }
+
+    auto it = summaries->find(CI->getCalledFunction());
+
+    return it == summaries->end() ? nullptr : &it->second;
+  }
+
+  // Resolves a summary set of the called function to the interned IDs of the caller
+  resolved_set resolveSummarySet(const summary_set &set)
+  {
+    resolved_set resolved;
+
+    resolved.params.assign(set.params.begin(), set.params.end());
+
+    for (const std::string &location : set.locations)
+    {
+      resolved.locations.push_back(getForeignID(location));
+    }
+
+    return resolved;
+  }
+
+  // Adds the location to the summary set, either as a parameter index or as a location qualified by the function name (globals are left unqualified)
+  void addToSummary(Function &F, int location, summary_set &set)
+  {
+    if (param_ids.count(location))
+    {
+      set.params.insert(param_ids[location]);
+    }
+    else if (foreign[location] || isa<GlobalValue>(values[location]))
+    {
+      set.locations.insert(getName(location));
+    }
+    else
+    {
+      set.locations.insert(std::string(F.getName()) + "::" + getName(location));
+    }
+  }
+
+  // Resolves the pointers read and written by the instruction to interned IDs
+  instruction_info getInstructionInfo(Instruction &I)
+  {
+    instruction_info info;
+    const function_summary *summary;
+
+    if (LoadInst *LI = dyn_cast<LoadInst>(&I))
+    {
+      if (LI->getType()->isPointerTy())
+      {
+        info.opcode = Instruction::Load;
+        info.ptr1 = getID(LI);
+        info.ptr2 = getAddressID(LI->getPointerOperand());
+      }
+    }
+    else if (StoreInst *SI = dyn_cast<StoreInst>(&I))
+    {
+      if (SI->getValueOperand()->getType()->isPointerTy())
+      {
+        info.opcode = Instruction::Store;
+        info.ptr1 = getAddressID(SI->getValueOperand());
+        info.ptr2 = getAddressID(SI->getPointerOperand());
+      }
+    }
+    else if (GetElementPtrInst *GEP = dyn_cast<GetElementPtrInst>(&I))
+    {
+      info.opcode = Instruction::GetElementPtr;
+      info.ptr1 = getID(GEP);
+      info.ptr2 = getID(GEP->getPointerOperand());
+      info.offsets_known = AliasMaxFields && getOffsets(GEP, info.offsets);
+    }
+    else if (AliasSSA && I.getType()->isPointerTy() && (isa<PHINode>(&I) || isa<SelectInst>(&I) || isa<CastInst>(&I)))
+    {
+      info.opcode = Instruction::PHI;  // Selects and casts copy their pointer operands like phis
+      info.ptr1 = getID(&I);
+
+      for (Value *operand : isa<SelectInst>(&I) ? drop_begin(I.operands()) : I.operands())
+      {
+        if (isTrackedPointer(operand))
+        {
+          info.sources.push_back(getAddressID(operand));
+        }
+      }
+    }
+    else if ((summary = getCalleeSummary(I)))
+    {
+      call_site_info call_site;
+
+      for (Value *arg : cast<CallInst>(&I)->args())
+      {
+        call_site.args.push_back(isTrackedPointer(arg) ? getAddressID(arg) : -1);
+      }
+
+      call_site.ret = resolveSummarySet(summary->ret);
+
+      for (auto &pair : summary->pointees)
+      {
+        call_site.pointees.push_back(std::make_pair(pair.first, resolveSummarySet(pair.second)));
+      }
+
+      info.opcode = Instruction::Call;
+      info.ptr1 = I.getType()->isPointerTy() ? getID(&I) : -1;
+      info.call_site = call_sites.size();
+
+      call_sites.push_back(call_site);
+    }
+
+    return info;
+  }
+
+  // Returns the locations which the actual argument points to
+  BitVector resolveArgument(const call_site_info &call_site, unsigned param, points_to_map &map)
+  {
+    BitVector locations(values.size());
+    int arg;
+
+    if (param < call_site.args.size() && call_site.args[param] >= 0)
+    {
+      arg = call_site.args[param];
+
+      if (named[arg])
+      {
+        locations.set(arg);
+      }
+      else if (isPointer(arg))
+      {
+        locations |= *getPointsTo(map, arg);
+      }
+    }
+
+    return locations;
+  }
+
+  // Returns the locations which the summary set stands for at the call site
+  BitVector resolveSet(const call_site_info &call_site, const resolved_set &set, points_to_map &map)
+  {
+    BitVector locations(values.size());
+
+    for (int location : set.locations)
+    {
+      locations.set(location);
+    }
+
+    for (unsigned param : set.params)
+    {
+      locations |= resolveArgument(call_site, param, map);
+    }
+
+    return locations;
+  }
+
+  // Applies the effect of the instruction to the points-to map
+  void transfer(const instruction_info &info, points_to_map &map)
+  {
+    int ptr1 = info.ptr1, ptr2 = info.ptr2, pointee;
+    BitVector pointees;
+
+    counters.transfers++;
+
+    if (info.opcode == Instruction::Load)
+    {
+      if (named[ptr2])
+      {
+        if (isPointer(ptr2))
+        {
+          setPointsTo(map, ptr1, map[ptr2]);
+        }
+      }
+      else
+      {
+        pointees = BitVector(values.size());
+
+        if (isPointer(ptr2))
+        {
+          for (int ptr : getPointsTo(map, ptr2)->set_bits())
+          {
+            if (isPointer(ptr))
+            {
+              pointees |= *map[ptr];
+            }
+          }
+        }
+
+        setPointsTo(map, ptr1, sets.get(pointees));
+      }
+    }
+    else if (info.opcode == Instruction::Store)
+    {
+      if (!isPointer(ptr2))
+      {
+        return;
+      }
+
+      if (named[ptr1] && named[ptr2])
+      {
+        map[ptr2] = sets.getSingleton(values.size(), ptr1);
+      }
+      else if (named[ptr1])
+      {
+        const points_to_set_table::handle &targets = getPointsTo(map, ptr2);
+
+        if (targets->count() == 1 && !fields[targets->find_first()].merged)
+        {
+          pointee = targets->find_first();
+
+          if (isPointer(pointee))
+          {
+            map[pointee] = sets.getSingleton(values.size(), ptr1);
+          }
+        }
+        else
+        {
+          pointees = *targets;
+
+          for (int ptr : pointees.set_bits())
+          {
+            if (isPointer(ptr))
+            {
+              map[ptr] = sets.getWith(map[ptr], ptr1);
+            }
+          }
+        }
+      }
+      else if (named[ptr2])
+      {
+        if (isPointer(ptr1))
+        {
+          map[ptr2] = getPointsTo(map, ptr1);
+        }
+      }
+      else
+      {
+        const points_to_set_table::handle &targets = getPointsTo(map, ptr2);
+
+        if (targets->count() == 1 && !fields[targets->find_first()].merged)
+        {
+          pointee = targets->find_first();
+
+          if (isPointer(pointee))
+          {
+            if (isPointer(ptr1))
+            {
+              map[pointee] = getPointsTo(map, ptr1);
+            }
+            else
+            {
+              map[pointee] = sets.get(BitVector(values.size()));
+            }
+          }
+        }
+        else if (isPointer(ptr1))
+        {
+          pointees = *targets;
+
+          for (int ptr : pointees.set_bits())
+          {
+            if (isPointer(ptr))
+            {
+              map[ptr] = sets.getUnion(map[ptr], getPointsTo(map, ptr1));
+            }
+          }
+        }
+      }
+    }
+    else if (info.opcode == Instruction::GetElementPtr)
+    {
+      if (AliasMaxFields && isPointer(ptr1))
+      {
+        pointees = BitVector(values.size());
+
+        if (named[ptr2])
+        {
+          addFieldsAt(info, ptr2, pointees);
+        }
+        else if (isPointer(ptr2))
+        {
+          for (int location : getPointsTo(map, ptr2)->set_bits())
+          {
+            addFieldsAt(info, location, pointees);
+          }
+        }
+
+        setPointsTo(map, ptr1, sets.get(pointees));
+      }
+      else if (isPointer(ptr1) && isPointer(ptr2))
+      {
+        setPointsTo(map, ptr1, getPointsTo(map, ptr2));
+      }
+    }
+    else if (info.opcode == Instruction::PHI)
+    {
+      pointees = BitVector(values.size());
+
+      for (int src : info.sources)
+      {
+        if (named[src])
+        {
+          pointees.set(src);
+        }
+        else if (isPointer(src))
+        {
+          pointees |= *getPointsTo(map, src);
+        }
+      }
+
+      setPointsTo(map, ptr1, sets.get(pointees));
+    }
+    else if (info.opcode == Instruction::Call)
+    {
+      const call_site_info &call_site = call_sites[info.call_site];
+      std::vector<std::pair<BitVector, BitVector>> updates; // Objects pointed to by an argument, and what the callee may store into them
+
+      // The summary is resolved against the map before the call, and the stores are applied as weak updates
+
+      for (auto &pair : call_site.pointees)
+      {
+        updates.push_back(std::make_pair(resolveArgument(call_site, pair.first, map), resolveSet(call_site, pair.second, map)));
+      }
+
+      if (isPointer(ptr1))
+      {
+        setPointsTo(map, ptr1, sets.get(resolveSet(call_site, call_site.ret, map)));
+      }
+
+      for (auto &update : updates)
+      {
+        for (int ptr : update.first.set_bits())
+        {
+          if (isPointer(ptr))
+          {
+            map[ptr] = sets.getUnion(map[ptr], update.second);
+          }
+        }
+      }
+    }
+  }
+
+  // Returns the points-to set of the pointer at the program point of the map
+  const points_to_set_table::handle &getPointsTo(const points_to_map &map, int ptr)
+  {
+    return ptr < num_cells ? map[ptr] : ssa_points_to[ptr - num_cells];
+  }
+
+  // Sets the points-to set of the pointer at the program point of the map
+  // The set of an SSA pointer holds at every program point, so it is only ever grown, and the basic blocks reading it become stale when it grows
+  void setPointsTo(points_to_map &map, int ptr, const points_to_set_table::handle &set)
+  {
+    if (ptr < num_cells)
+    {
+      map[ptr] = set;
+      return;
+    }
+
+    points_to_set_table::handle &ssa_set = ssa_points_to[ptr - num_cells];
+    points_to_set_table::handle merged = sets.getUnion(ssa_set, set);
+
+    if (merged != ssa_set)
+    {
+      ssa_set = merged;
+      stale_blocks.insert(stale_blocks.end(), ssa_users[ptr - num_cells].begin(), ssa_users[ptr - num_cells].end());
+    }
+  }
+
+  // Solves the constraints of every instruction with the given flow-insensitive solver, and calculates alias_map from the solution
+  // Returns false (with no alias_map) if the budget runs out first
+  // Each instruction is turned into constraints mirroring its flow-sensitive transfer function, without the strong updates
+  template <typename solver_t>
+  bool runFlowInsensitive(solver_t &solver, analysis_budget &budget)
+  {
+    points_to_map points_to;
+    BitVector locations;
+
+    for (int ptr = 0; ptr < num_cells; ptr++)
+    {
+      for (int location : initial_points_to_map[ptr]->set_bits())
+      {
+        solver.addAddressOf(ptr, location);
+      }
+    }
+
+    for (const instruction_info &info : instruction_infos)
+    {
+      addConstraints(info, solver);
+    }
+
+    bool solved = solver.solve(budget);
+
+    counters.worklist_pops += solver.getIterations();
+    counters.transfers += instruction_infos.size();
+    counters.meets += solver.getMeets();
+
+    if (!solved)
+    {
+      return false;
+    }
+
+    for (int ptr = 0; ptr < num_pointers; ptr++)
+    {
+      locations.clear();
+      locations.resize(values.size());
+
+      for (unsigned location : solver.getPointsTo(ptr))
+      {
+        locations.set(location);
+      }
+
+      points_to.push_back(sets.get(locations));
+    }
+
+    counters.lattice_size += countPairs(points_to);
+
+    calculateAliasMap(points_to);
+
+    return true;
+  }
+
+  // Adds the constraints corresponding to the transfer function of the instruction
+  template <typename solver_t>
+  void addConstraints(const instruction_info &info, solver_t &solver)
+  {
+    int ptr1 = info.ptr1, ptr2 = info.ptr2;
+
+    if (info.opcode == Instruction::Load && isPointer(ptr2))
+    {
+      if (named[ptr2])
+      {
+        solver.addCopy(ptr1, ptr2);
+      }
+      else
+      {
+        solver.addLoad(ptr1, ptr2);
+      }
+    }
+    else if (info.opcode == Instruction::Store && isPointer(ptr2))
+    {
+      if (named[ptr1] && named[ptr2])
+      {
+        solver.addAddressOf(ptr2, ptr1);
+      }
+      else if (named[ptr1])
+      {
+        solver.addStoreAddress(ptr2, ptr1);
+      }
+      else if (named[ptr2])
+      {
+        if (isPointer(ptr1))
+        {
+          solver.addCopy(ptr2, ptr1);
+        }
+      }
+      else if (isPointer(ptr1))
+      {
+        solver.addStore(ptr2, ptr1);
+      }
+    }
+    else if (info.opcode == Instruction::GetElementPtr && AliasMaxFields && isPointer(ptr1))
+    {
+      if (named[ptr2])
+      {
+        BitVector locations(values.size());
+
+        addFieldsAt(info, ptr2, locations);
+
+        for (int location : locations.set_bits())
+        {
+          solver.addAddressOf(ptr1, location);
+        }
+      }
+      else if (isPointer(ptr2))
+      {
+        solver.addCopy(ptr1, ptr2); // Exact when the offset is zero, as the same field is pointed to
+
+        // Otherwise, the fields at the offsets from the fields which the base points to cannot be expressed as constraints, so any field may be pointed to
+
+        if (!info.offsets_known || info.offsets.size() != 1 || info.offsets[0] != 0)
+        {
+          for (auto &pair : object_fields)
+          {
+            for (int field : pair.second)
+            {
+              solver.addAddressOf(ptr1, field);
+            }
+          }
+        }
+      }
+    }
+    else if (info.opcode == Instruction::GetElementPtr && isPointer(ptr1) && isPointer(ptr2))
+    {
+      solver.addCopy(ptr1, ptr2);
+    }
+    else if (info.opcode == Instruction::PHI)
+    {
+      for (int src : info.sources)
+      {
+        if (named[src])
+        {
+          solver.addAddressOf(ptr1, src);
+        }
+        else if (isPointer(src))
+        {
+          solver.addCopy(ptr1, src);
+        }
+      }
+    }
+  }
+
+  // Numbers the instructions, interns the pointers and locations of the function, and calculates the initial points-to map
+  void prepare(Function &F)
+  {
+    std::vector<int> array_ids; // IDs of the arrays, which initially point to their first fields
+    std::vector<std::pair<AllocaInst *, std::vector<field_info>>> objects; // Struct and array allocas with their fields
+
+    numberInstructions(F);
+
+    function = &F;
+    ids.clear();
+    foreign_ids.clear();
+    values.clear();
+    foreign_names.clear();
+    named.clear();
+    foreign.clear();
+    fields.clear();
+    object_fields.clear();
+    instruction_infos.clear();
+    call_sites.clear();
+    param_ids.clear();
+    reported_ids.clear();
+    alias_map.clear();
+
+    // Interning the pointers defined by the instructions
+    // In SSA form the loads and getelementptrs define SSA pointers, which are interned after the pointers whose points-to sets vary between program points
+
+    for (Instruction *I : instructions)
+    {
+      if (AllocaInst *AI = dyn_cast<AllocaInst>(I))
+      {
+        if (AI->getAllocatedType()->isPointerTy())
+        {
+          reported_ids.push_back(getID(AI));
+        }
+        else if (AI->getAllocatedType()->isArrayTy())
+        {
+          reported_ids.push_back(getID(AI));
+          array_ids.push_back(reported_ids.back());
+        }
+
+        objects.push_back(std::make_pair(AI, getFields(*AI)));
+
+        if (objects.back().second.empty())
+        {
+          objects.pop_back();
+        }
+      }
+      else if (!AliasSSA && ((isa<LoadInst>(I) && I->getType()->isPointerTy()) || isa<GetElementPtrInst>(I)))
+      {
+        getID(I);
+      }
+    }
+
+    if (summaries)
+    {
+      // The object which each pointer parameter points to is tracked, so that stores into it can be summarized
+
+      for (Argument &Arg : F.args())
+      {
+        if (Arg.getType()->isPointerTy())
+        {
+          param_ids[getID(&Arg)] = Arg.getArgNo();
+        }
+      }
+
+      // The results of calls to summarized functions are pointer values, and are tracked so that storing them copies their points-to sets
+
+      for (Instruction *I : instructions)
+      {
+        if (!AliasSSA && getCalleeSummary(*I) && I->getType()->isPointerTy())
+        {
+          getID(I);
+        }
+      }
+    }
+
+    // The fields which may hold pointers are cells, like pointer variables
+
+    for (auto &object : objects)
+    {
+      object_fields[object.first].assign(object.second.size(), -1);
+
+      for (field_info &field : object.second)
+      {
+        if (field.holds_pointers)
+        {
+          object_fields[object.first][field.index] = addField(object.first, field);
+        }
+      }
+    }
+
+    num_cells = values.size();
+
+    if (AliasSSA)
+    {
+      for (Instruction *I : instructions)
+      {
+        if (isSSAPointer(*I))
+        {
+          int id = getID(I);
+
+          if (I->hasName())  // Only the named SSA pointers are reported, as the unnamed ones are temporaries
+          {
+            reported_ids.push_back(id);
+          }
+        }
+      }
+    }
+
+    num_pointers = values.size();
+
+    // Interning the locations which the pointers can point to
+
+    for (auto &object : objects)
+    {
+      for (field_info &field : object.second)
+      {
+        if (!field.holds_pointers)
+        {
+          object_fields[object.first][field.index] = addField(object.first, field);
+        }
+      }
+    }
+
+    for (Instruction *I : instructions)
+    {
+      instruction_infos.push_back(getInstructionInfo(*I));
+    }
+
+    // Calculating the initial values for the points-to maps, and the basic blocks reading each SSA pointer
+
+    initial_points_to_map.assign(num_cells, sets.get(BitVector(values.size())));
+    ssa_points_to.assign(num_pointers - num_cells, sets.get(BitVector(values.size())));
+    ssa_users.assign(num_pointers - num_cells, std::vector<int>());
+    stale_blocks.clear();
+
+    for (int i = 0; i < (int)instruction_infos.size(); i++)
+    {
+      for (int ptr : getOperandPointers(instruction_infos[i]))
+      {
+        if (ptr >= num_cells && ptr < num_pointers && (ssa_users[ptr - num_cells].empty() || ssa_users[ptr - num_cells].back() != instruction_blocks[i]))
+        {
+          ssa_users[ptr - num_cells].push_back(instruction_blocks[i]);
+        }
+      }
+    }
+
+    for (int id : array_ids)
+    {
+      initial_points_to_map[id] = sets.getSingleton(values.size(), object_fields[values[id]].front());
+    }
+  }
+
+  // Adds the ID of a field of the struct or array alloca
+  int addField(const AllocaInst *AI, const field_info &field)
+  {
+    int id = addID(AI, true, false);
+
+    fields[id] = field;
+
+    return id;
+  }
+
+  // Returns the fields which the struct or array alloca is split into, at most AliasMaxFields of them, followed by one covering the whole object
+  // With AliasMaxFields = 0 an array is represented by its first element, which stands for all of them
+  std::vector<field_info> getFields(AllocaInst &AI)
+  {
+    const DataLayout &DL = AI.getModule()->getDataLayout();
+    Type *T = AI.getAllocatedType();
+    std::vector<field_info> fields;
+
+    if (!T->isStructTy() && !T->isArrayTy())
+    {
+      return fields;
+    }
+
+    uint64_t size = DL.getTypeAllocSize(T);
+
+    if (!AliasMaxFields)
+    {
+      if (T->isArrayTy())
+      {
+        fields.emplace_back();
+        fields.back().index = 0;
+        fields.back().end = size;
+        fields.back().merged = true;
+        fields.back().name = "[0]";
+      }
+
+      return fields;
+    }
+
+    flattenType(DL, T, 0, "", AliasMaxFields + 1, fields); // Flattening one field more than the cap tells whether the object has to be split at it
+
+    if (fields.size() > AliasMaxFields)
+    {
+      fields.resize(AliasMaxFields);
+      fields.back().merged = true;
+      fields.back().holds_pointers = containsPointer(T);
+      fields.back().name += "...";
+    }
+
+    for (int i = 0; i < (int)fields.size(); i++)
+    {
+      fields[i].end = i + 1 < (int)fields.size() ? fields[i + 1].begin : size;
+    }
+
+    fields.emplace_back();  // The object as a whole, for pointers to unknown places in it
+    fields.back().end = size;
+    fields.back().merged = true;
+    fields.back().holds_pointers = false;
+
+    for (int i = 0; i < (int)fields.size(); i++)
+    {
+      fields[i].index = i;
+    }
+
+    return fields;
+  }
+
+  // Appends the scalar fields of the type at the given offset, named by their paths, until there are limit fields
+  static void flattenType(const DataLayout &DL, Type *T, uint64_t offset, const std::string &name, unsigned limit, std::vector<field_info> &fields)
+  {
+    if (StructType *ST = dyn_cast<StructType>(T))
+    {
+      const StructLayout *SL = DL.getStructLayout(ST);
+
+      for (unsigned i = 0; i < ST->getNumElements() && fields.size() < limit; i++)
+      {
+        flattenType(DL, ST->getElementType(i), offset + SL->getElementOffset(i), name + "." + std::to_string(i), limit, fields);
+      }
+    }
+    else if (ArrayType *AT = dyn_cast<ArrayType>(T))
+    {
+      uint64_t element_size = DL.getTypeAllocSize(AT->getElementType());
+
+      for (uint64_t i = 0; i < AT->getNumElements() && fields.size() < limit; i++)
+      {
+        flattenType(DL, AT->getElementType(), offset + i * element_size, name + "[" + std::to_string(i) + "]", limit, fields);
+      }
+    }
+    else if (fields.size() < limit)
+    {
+      fields.emplace_back();
+      fields.back().begin = offset;
+      fields.back().holds_pointers = containsPointer(T);
+      fields.back().name = name;
+    }
+  }
+
+  // Checks if a value of the type may hold a pointer
+  static bool containsPointer(Type *T)
+  {
+    if (StructType *ST = dyn_cast<StructType>(T))
+    {
+      return any_of(ST->elements(), containsPointer);
+    }
+
+    if (ArrayType *AT = dyn_cast<ArrayType>(T))
+    {
+      return containsPointer(AT->getElementType());
+    }
+
+    if (VectorType *VT = dyn_cast<VectorType>(T))
+    {
+      return containsPointer(VT->getElementType());
+    }
+
+    return T->isPointerTy();
+  }
+
+  // Calculates the byte offsets which the getelementptr may add to its base, returning false if they are not known or too many
+  // A variable index into an array gives an offset for each element, while a variable first index may step anywhere
+  bool getOffsets(GetElementPtrInst *GEP, std::vector<int64_t> &offsets)
+  {
+    const DataLayout &DL = GEP->getModule()->getDataLayout();
+    Type *T = GEP->getSourceElementType();
+    std::vector<int64_t> stepped;
+
+    offsets.assign(1, 0);
+
+    if (GEP->getType()->isVectorTy())
+    {
+      return false;
+    }
+
+    for (auto it = GEP->idx_begin(); it != GEP->idx_end(); ++it)
+    {
+      ConstantInt *CI = dyn_cast<ConstantInt>(*it);
+      bool first = it == GEP->idx_begin();
+
+      if (StructType *ST = first ? nullptr : dyn_cast<StructType>(T))  // Struct indices are constants
+      {
+        for (int64_t &offset : offsets)
+        {
+          offset += DL.getStructLayout(ST)->getElementOffset(CI->getZExtValue());
+        }
+
+        T = ST->getElementType(CI->getZExtValue());
+
+        continue;
+      }
+
+      if (!first && !T->isArrayTy())
+      {
+        return false;
+      }
+
+      Type *element = first ? T : T->getArrayElementType();
+      int64_t element_size = DL.getTypeAllocSize(element);
+
+      if (CI)
+      {
+        for (int64_t &offset : offsets)
+        {
+          offset += CI->getSExtValue() * element_size;
+        }
+      }
+      else if (first || offsets.size() * T->getArrayNumElements() > std::max(64u, 2 * (unsigned)AliasMaxFields))
+      {
+        return false;
+      }
+      else
+      {
+        stepped.clear();
+
+        for (int64_t offset : offsets)
+        {
+          for (uint64_t i = 0; i < T->getArrayNumElements(); i++)
+          {
+            stepped.push_back(offset + i * element_size);
+          }
+        }
+
+        offsets.swap(stepped);
+      }
+
+      T = element;
+    }
+
+    return true;
+  }
+
+  // Adds the locations which the getelementptr points to when its base points to the given location
+  // A pointer to a field points to its start, and moving it by the offset lands on the start of another field or inside one; in the latter case, and when
+  // the offset is not known or leaves the object, it may point anywhere in the object, which its last field (covering all of it) stands for
+  // Other locations are not split, and are added whole
+  void addFieldsAt(const instruction_info &info, int location, BitVector &locations)
+  {
+    auto it = values[location] ? object_fields.find(values[location]) : object_fields.end();
+
+    if (it == object_fields.end())
+    {
+      locations.set(location);
+
+      return;
+    }
+
+    const std::vector<int> &object = it->second;
+    const field_info &base = fields[location];  // The object itself when the base is the alloca, which points to its start
+    std::vector<int> targets;
+    bool known = info.offsets_known;
+
+    for (int64_t offset : info.offsets)
+    {
+      int field = base.merged ? (offset == 0 ? location : -1) : getFieldAt(object, (base.index >= 0 ? base.begin : 0) + offset);
+
+      if (field < 0)
+      {
+        known = false;
+        break;
+      }
+
+      targets.push_back(field);
+    }
+
+    for (int field : known ? targets : object)
+    {
+      locations.set(field);
+    }
+  }
+
+  // Returns the field of the object starting at the offset, or the merged field containing it, or -1 if there is none
+  int getFieldAt(const std::vector<int> &object, int64_t offset)
+  {
+    for (int field : object)
+    {
+      if ((int64_t)fields[field].begin <= offset && offset < (int64_t)fields[field].end)
+      {
+        return fields[field].begin == (uint64_t)offset || fields[field].merged ? field : -1;
+      }
+    }
+
+    return -1;
+  }
+
+  // Numbers the instructions and basic blocks of the function, and records the predecessors and successors of each basic block
+  void numberInstructions(Function &F)
+  {
+    BasicBlock *successor;
+
+    instructions.clear();
+    instruction_numbers.clear();
+    blocks.clear();
+    block_numbers.clear();
+    instruction_blocks.clear();
+    block_start.clear();
+    block_end.clear();
+    predecessors.clear();
+    successors.clear();
+
+    for (BasicBlock &BB : F)
+    {
+      block_numbers[&BB] = block_start.size();
+      blocks.push_back(&BB);
+      block_start.push_back(instructions.size());
+
+      for (Instruction &I : BB)
+      {
+        instruction_numbers[&I] = instructions.size();
+        instructions.push_back(&I);
+        instruction_blocks.push_back(block_start.size() - 1);
+      }
+
+      block_end.push_back(instructions.size() - 1);
+    }
+
+    predecessors.resize(block_start.size());
+    successors.resize(block_start.size());
+
+    for (BasicBlock &BB : F)
+    {
+      for (unsigned j = 0; j < BB.getTerminator()->getNumSuccessors(); j++)
+      {
+        successor = BB.getTerminator()->getSuccessor(j);
+
+        predecessors[block_numbers[successor]].push_back(block_numbers[&BB]);
+        successors[block_numbers[&BB]].push_back(block_numbers[successor]);
+      }
+    }
+  }
+
+  // Runs the worklist algorithm until the OUT maps of the basic blocks stop changing, returning false if the budget runs out first
+  bool propagate(rpo_worklist &worklist, analysis_budget &budget)
+  {
+    int i;
+    uint64_t pops = 0;
+
+    points_to_map new_out;
+
+    while (!worklist.empty()) // Performing the may-alias analysis
+    {
+      i = block_numbers[worklist.pop()];  // Removing the first basic block in reverse postorder from the worklist
+      counters.worklist_pops++;
+
+      if (budget.isExceeded(++pops))
+      {
+        return false;
+      }
+
+      calculateBlockIn(i, block_in[i]); // Calculating the IN map
+
+      new_out = block_in[i];
+
+      transferBlock(i, block_end[i], new_out);  // Calculating the new OUT map
+
+      for (int block : stale_blocks) // Adding the basic blocks which read the SSA pointers whose points-to sets have grown to the worklist
+      {
+        worklist.push(blocks[block]);
+      }
+
+      stale_blocks.clear();
+
+      if (block_out[i] == new_out) // Checking if the old OUT map is equal to the new OUT map
+      {
+        continue;
+      }
+
+      block_out[i].swap(new_out); // Replacing the old OUT map with the new OUT map
+
+      for (int successor : successors[i])  // Adding all the successor basic blocks to the worklist
+      {
+        worklist.push(blocks[successor]);
+      }
+    }
+
+    return true;
+  }
+
+  // Calculates alias_map from the OUT map of the last instruction, and the points-to sets of the SSA pointers
+  void calculateFinalAliasMap()
+  {
+    points_to_map final_out = getOutMap(instructions.size() - 1);
+
+    final_out.insert(final_out.end(), ssa_points_to.begin(), ssa_points_to.end());
+
+    counters.lattice_size += countPairs(final_out);
+
+    calculateAliasMap(final_out);
+  }
+
+  // Hashes the instructions of the basic block, their operands and the predecessors of the basic block, which together determine its transfer
+  hash_code hashBlock(int block_number)
+  {
+    hash_code hash = hash_value(blocks[block_number]);
+
+    for (int predecessor : predecessors[block_number])
+    {
+      hash = hash_combine(hash, blocks[predecessor]);
+    }
+
+    for (int i = block_start[block_number]; i <= block_end[block_number]; i++)
+    {
+      hash = hash_combine(hash, instructions[i], instructions[i]->getOpcode(),
+                          hash_combine_range(instructions[i]->value_op_begin(), instructions[i]->value_op_end()));
+    }
+
+    return hash;
+  }
+
+  // Records the values and basic blocks behind the IDs, and the hashes of the basic blocks, for the next update
+  // The handles become null when the values are deleted, so that a new value reusing the address of a deleted one is not mistaken for it
+  void takeSnapshot()
+  {
+    snapshot_values.clear();
+    snapshot_blocks.clear();
+    snapshot_hashes.clear();
+
+    for (const Value *V : values)
+    {
+      snapshot_values.emplace_back(const_cast<Value *>(V));
+    }
+
+    for (int i = 0; i < (int)blocks.size(); i++)
+    {
+      snapshot_blocks.emplace_back(blocks[i]);
+      snapshot_hashes.push_back(hashBlock(i));
+    }
+  }
+
+  // Returns the points-to set over the old IDs as a set over the new IDs, dropping the locations which no longer exist
+  points_to_set_table::handle translateSet(const points_to_set_table::handle &set, const std::vector<int> &new_ids,
+                                           DenseMap<const BitVector *, points_to_set_table::handle> &translated)
+  {
+    auto it = translated.find(&*set);
+
+    if (it != translated.end())
+    {
+      return it->second;
+    }
+
+    BitVector locations(values.size());
+
+    for (int location : set->set_bits())
+    {
+      if (new_ids[location] >= 0)
+      {
+        locations.set(new_ids[location]);
+      }
+    }
+
+    return translated[&*set] = sets.get(locations);
+  }
+
+  // Returns the points-to map over the old IDs as a map over the new IDs, starting the new cells from their initial points-to sets
+  points_to_map translateMap(const points_to_map &map, int old_num_cells, const std::vector<int> &new_ids,
+                             DenseMap<const BitVector *, points_to_set_table::handle> &translated)
+  {
+    points_to_map new_map = initial_points_to_map;
+
+    for (int ptr = 0; ptr < old_num_cells; ptr++)
+    {
+      if (new_ids[ptr] >= 0 && new_ids[ptr] < num_cells)
+      {
+        new_map[new_ids[ptr]] = translateSet(map[ptr], new_ids, translated);
+      }
+    }
+
+    return new_map;
+  }
+
+  // Calculates the IN map of the basic block from the OUT maps of its predecessors
+  void calculateBlockIn(int block_number, points_to_map &map)
+  {
+    map = initial_points_to_map;
+
+    for (int predecessor : predecessors[block_number])
+    {
+      counters.meets++;
+
+      for (int ptr = 0; ptr < num_cells; ptr++)
+      {
+        map[ptr] = sets.getUnion(map[ptr], block_out[predecessor][ptr]);
+      }
+    }
+  }
+
+  // Applies the instructions of the basic block up to (and including) the given instruction number to the map
+  void transferBlock(int block_number, int last_instruction_number, points_to_map &map)
+  {
+    for (int i = block_start[block_number]; i <= last_instruction_number; i++)
+    {
+      transfer(instruction_infos[i], map);
+    }
+  }
+
+  // Returns the OUT map of the given instruction, recomputing it from the IN map of its basic block
+  points_to_map getOutMap(int instruction_number)
+  {
+    int block_number = instruction_blocks[instruction_number];
+    points_to_map map = block_in[block_number];
+
+    transferBlock(block_number, instruction_number, map);
+
+    return map;
+  }
+
+  // Returns the number of (pointer, location) pairs in the points-to map
+  static uint64_t countPairs(const points_to_map &map)
+  {
+    uint64_t pairs = 0;
+
+    for (const points_to_set_table::handle &points_to : map)
+    {
+      pairs += points_to->count();
+    }
+
+    return pairs;
+  }
+
+  // Calculates alias_map from the given points-to sets of all the pointers
+  // The reported pointers are bucketed by the locations they point to, so that each pointer is only compared with the pointers sharing a location with it
+  void calculateAliasMap(const points_to_map &final_out)
+  {
+    std::vector<std::vector<int>> pointers_to(values.size()); // Location -> reported pointers which point to it
+    std::vector<std::string> pointer_names(num_pointers);
+    std::vector<int> last_seen(num_pointers, -1); // Pointer -> the last pointer whose aliases it was added to
+    std::set<std::string> aliases;
+
+    for (int ptr : reported_ids)
+    {
+      pointer_names[ptr] = getName(ptr);
+
+      for (int location : final_out[ptr]->set_bits())
+      {
+        pointers_to[location].push_back(ptr);
+      }
+    }
+
+    for (int ptr : reported_ids)
+    {
+      aliases.clear();
+
+      for (int location : final_out[ptr]->set_bits())
+      {
+        for (int other_ptr : pointers_to[location])
+        {
+          if (other_ptr != ptr && last_seen[other_ptr] != ptr)
+          {
+            last_seen[other_ptr] = ptr;
+            aliases.insert(pointer_names[other_ptr]);
+          }
+        }
+      }
+
+      alias_map.push_back(std::make_pair(pointer_names[ptr], aliases));
+    }
+  }
+};
+
+// Runs independent tasks on a fixed number of threads
+// Each thread owns a deque of task indices which it pops from the back, and when it runs out it steals from the front of another thread's deque
+class work_stealing_pool
+{
+public:
+  explicit work_stealing_pool(unsigned num_threads) : queues(std::max(1u, num_threads)) {}
+
+  // Runs task(i) for every i in [0, num_tasks), in the order given by priority (highest first) as far as stealing allows, and waits for all of them
+  void run(int num_tasks, const std::function<void(int)> &task, const std::function<uint64_t(int)> &priority)
+  {
+    std::vector<int> order(num_tasks);
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < num_tasks; i++)
+    {
+      order[i] = i;
+    }
+
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return priority(a) > priority(b); });
+
+    for (int i = 0; i < num_tasks; i++)  // Dealing the tasks out round-robin, so that every thread starts with a share of the expensive ones
+    {
+      queues[i % queues.size()].tasks.push_front(order[i]);
+    }
+
+    for (unsigned id = 1; id < queues.size(); id++)
+    {
+      threads.emplace_back([this, id, &task]() { work(id, task); });
+    }
+
+    work(0, task);
+
+    for (std::thread &thread : threads)
+    {
+      thread.join();
+    }
+  }
+
+private:
+  struct task_queue
+  {
+    std::mutex lock;
+    std::deque<int> tasks;
+  };
+
+  std::vector<task_queue> queues;
+
+  // Takes a task from the back of the thread's own deque, or else from the front of another one
+  bool take(unsigned id, int &task)
+  {
+    for (unsigned i = 0; i < queues.size(); i++)
+    {
+      task_queue &queue = queues[(id + i) % queues.size()];
+      std::lock_guard<std::mutex> guard(queue.lock);
+
+      if (!queue.tasks.empty())
+      {
+        if (i == 0)
+        {
+          task = queue.tasks.back();
+          queue.tasks.pop_back();
+        }
+        else
+        {
+          task = queue.tasks.front();
+          queue.tasks.pop_front();
+        }
+
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  void work(unsigned id, const std::function<void(int)> &task)
+  {
+    int index;
+
+    while (take(id, index))  // No tasks are added while the pool runs, so an empty sweep means that all of them have been taken
+    {
+      task(index);
+    }
+  }
+};
+
+// Returns the name of the analysis, as given to -alias-mode
+StringRef getModeName(alias_mode mode)
+{
+  switch (mode)
+  {
+  case FLOW_SENSITIVE:
+    return "flow-sensitive";
+  case ANDERSEN:
+    return "andersen";
+  case STEENSGAARD:
+    return "steensgaard";
+  case DEMAND_DRIVEN:
+    return "demand";
+  }
+
+  llvm_unreachable("unknown alias mode");
+}
+
+// The alias report of a module, written through one buffered stream which is opened when the report is created and flushed when it is destroyed
+class alias_report
+{
+public:
+  explicit alias_report(Module &M)
+  {
+    std::error_code EC;
+    SmallString<128> path;
+
+    if (AliasOutput.empty())
+    {
+      path = AliasOutputDir;
+
+      sys::path::append(path, sys::path::stem(M.getName()) + (AliasOutputFormat == JSON_OUTPUT ? ".jsonl" : ".txt"));
+    }
+    else
+    {
+      path = AliasOutput;
+    }
+
+    output_file.reset(new raw_fd_ostream(path, EC, sys::fs::OF_Text));
+
+    if (EC)
+    {
+      errs() << "alias_lib: cannot open " << path << ": " << EC.message() << "\n";
+      output_file.reset();
+    }
+  }
+
+  // Writes the alias map of the function, and the analysis (the tier) which produced it
+  // The text report only names the tier of a function when it differs from the one selected by -alias-mode
+  void print(Function &F, const alias_map_t &alias_map, alias_mode tier)
+  {
+    std::string text;
+    raw_string_ostream rso(text);
+
+    if (AliasEcho || (output_file && AliasOutputFormat == TEXT_OUTPUT))
+    {
+      printText(rso, F, alias_map, tier);
+    }
+
+    if (output_file)
+    {
+      if (AliasOutputFormat == JSON_OUTPUT)
+      {
+        printJSON(*output_file, F, alias_map, tier);
+      }
+      else
+      {
+        *output_file << rso.str();
+      }
+    }
+
+    if (AliasEcho)
+    {
+      errs() << rso.str();
+    }
+  }
+
+private:
+  std::unique_ptr<raw_fd_ostream> output_file;
+
+  // Removes the .addr from the pointer name
+  static StringRef getPointerName(const std::string &name)
+  {
+    return StringRef(name).substr(0, name.find_last_of('.'));
+  }
+
+  static void printText(raw_ostream &OS, Function &F, const alias_map_t &alias_map, alias_mode tier)
+  {
+    OS << F.getName();
+
+    if (tier != AliasMode)
+    {
+      OS << " [" << getModeName(tier) << "]";
+    }
+
+    OS << "\n";
+
+    for (auto &pair : alias_map)
+    {
+      OS << getPointerName(pair.first) << " -> {";
+
+      for (auto alias = pair.second.begin(); alias != pair.second.end(); alias++)
+      {
+        OS << (alias == pair.second.begin() ? "" : ", ") << getPointerName(*alias);
+      }
+
+      OS << "}\n";
+    }
+  }
+
+  // Prints {"function": ..., "tier": ..., "pointers": [{"pointer": ..., "aliases": [...]}, ...]} on one line
+  static void printJSON(raw_ostream &OS, Function &F, const alias_map_t &alias_map, alias_mode tier)
+  {
+    json::OStream J(OS);
+
+    J.object([&] {
+      J.attribute("function", F.getName());
+      J.attribute("tier", getModeName(tier));
+      J.attributeArray("pointers", [&] {
+        for (auto &pair : alias_map)
+        {
+          J.object([&] {
+            J.attribute("pointer", getPointerName(pair.first));
+            J.attributeArray("aliases", [&] {
+              for (const std::string &alias : pair.second)
+              {
+                J.value(getPointerName(alias));
+              }
+            });
+          });
+        }
+      });
+    });
+
+    OS << "\n";
+  }
+};
+
+// Analyzes the function with the analysis selected by -alias-mode, and returns the analysis (the tier) which produced its alias map
+// A function over its budget falls back to the next cheaper analysis, each of which over-approximates the previous one: the flow-sensitive analysis is
+// limited by -alias-max-instructions, -alias-max-worklist-pops and -alias-max-time-ms, the inclusion-based one by -alias-max-time-ms, and the
+// unification-based one always completes
+// timed_out is set if a tier ran out of time, in which case the result depends on the speed of the machine
+alias_mode analyzeFunction(Function &F, points_to_analysis &analysis, bool &timed_out)
+{
+  alias_mode tier = AliasMode;
+
+  timed_out = false;
+
+  if (tier == FLOW_SENSITIVE)
+  {
+    analysis_budget budget(AliasMaxWorklistPops, AliasMaxTime);
+
+    if ((!AliasMaxInstructions || F.getInstructionCount() <= AliasMaxInstructions) && analysis.run(F, budget))
+    {
+      return tier;
+    }
+
+    timed_out |= budget.hasTimedOut();
+    tier = ANDERSEN;
+  }
+
+  if (tier == ANDERSEN)
+  {
+    analysis_budget budget(0, AliasMaxTime);
+
+    if (analysis.runAndersen(F, budget))
+    {
+      return tier;
+    }
+
+    timed_out |= budget.hasTimedOut();
+    tier = STEENSGAARD;
+  }
+
+  if (tier == DEMAND_DRIVEN)
+  {
+    analysis.runDemand(F);  // Each query has its own budget, given by -alias-query-budget
+  }
+  else
+  {
+    analysis.runSteensgaard(F);
+  }
+
+  return tier;
+}
+
+// A persistent cache of the alias maps of functions, used by alias_lib_given and alias_lib_parallel
+// Each entry is a file named by a hash of the function's instructions, value names and types, and of the analysis options, so unchanged functions hit across modules and builds
+// Only the alias maps are stored, since they are all that the reports need; the points-to maps stay internal to points_to_analysis
+// Entries are written atomically, so concurrent runs may share the directory
+class alias_result_cache
+{
+public:
+  // Fills alias_map and the tier which produced it from the cache entry of the function, returning false on a miss
+  static bool lookup(Function &F, alias_map_t &alias_map, alias_mode &tier)
+  {
+    if (AliasCacheDir.empty())
+    {
+      return false;
+    }
+
+    ErrorOr<std::unique_ptr<MemoryBuffer>> buffer = MemoryBuffer::getFile(getPath(F), false, false);  // Mapped into memory, rather than read, when large enough
+
+    if (!buffer)
+    {
+      return false;
+    }
+
+    StringRef data = (*buffer)->getBuffer();
+    StringRef name, pointer, alias;
+    uint32_t tier_number, num_pointers, num_aliases;
+
+    if (!data.consume_front(magic) || !readString(data, name) || name != F.getName() || !readInt(data, tier_number) || !readInt(data, num_pointers))  // Guarding against hash collisions between functions
+    {
+      return false;
+    }
+
+    tier = (alias_mode)tier_number;
+
+    alias_map.clear();
+
+    for (uint32_t i = 0; i < num_pointers; i++)
+    {
+      if (!readString(data, pointer) || !readInt(data, num_aliases))
+      {
+        return false;
+      }
+
+      alias_map.push_back(std::make_pair(pointer.str(), std::set<std::string>{}));
+
+      for (uint32_t j = 0; j < num_aliases; j++)
+      {
+        if (!readString(data, alias))
+        {
+          return false;
+        }
+
+        alias_map.back().second.insert(alias.str());
+      }
+    }
+
+    return data.empty();
+  }
+
+  // Records the alias map of the function, and the tier which produced it
+  // A result for which a tier ran out of time depends on the speed of the machine, and is not recorded, which is why -alias-max-time-ms is not part of the key
+  static void store(Function &F, const alias_map_t &alias_map, alias_mode tier, bool timed_out)
+  {
+    std::string path;
+
+    if (AliasCacheDir.empty() || timed_out)
+    {
+      return;
+    }
+
+    path = getPath(F);
+
+    sys::fs::create_directories(AliasCacheDir);
+
+    Error E = writeFileAtomically(path + "-%%%%%%%%", path, [&](raw_ostream &OS) {
+      support::endian::Writer writer(OS, support::little);
+
+      OS << magic;
+      writeString(writer, F.getName());
+      writer.write<uint32_t>(tier);
+      writer.write<uint32_t>(alias_map.size());
+
+      for (auto &pair : alias_map)
+      {
+        writeString(writer, pair.first);
+        writer.write<uint32_t>(pair.second.size());
+
+        for (const std::string &alias : pair.second)
+        {
+          writeString(writer, alias);
+        }
+      }
+
+      return Error::success();
+    });
+
+    consumeError(std::move(E)); // A cache entry which cannot be written is simply recomputed next time
+  }
+
+private:
+  static constexpr const char *magic = "ALIASLIB3\n";
+
+  static std::string getPath(Function &F)
+  {
+    SmallString<128> path(AliasCacheDir);
+
+    sys::path::append(path, utohexstr(getKey(F), false, 16) + ".alias");
+
+    return std::string(path);
+  }
+
+  // Hashes an encoding of everything that the alias map of the function depends on
+  static uint64_t getKey(Function &F)
+  {
+    SmallString<4096> buffer;
+    raw_svector_ostream OS(buffer);
+    DenseMap<const Value *, unsigned> numbers;
+    SmallPtrSet<StructType *, 16> structs;  // The identified structs whose bodies have been encoded
+
+    OS << magic << (int)AliasMode << " " << AliasQueryBudget << " " << AliasSSA << " " << AliasMaxFields << " " << AliasMaxInstructions << " " << AliasMaxWorklistPops << " " << F.getName()
+       << "\n";
+    OS << F.getParent()->getDataLayout().getStringRepresentation() << "\n";  // The offsets of the fields depend on it
+
+    for (Argument &Arg : F.args())
+    {
+      numbers[&Arg] = numbers.size();
+    }
+
+    for (BasicBlock &BB : F)  // Numbering the values first, so that operands defined later can be encoded
+    {
+      numbers[&BB] = numbers.size();
+
+      for (Instruction &I : BB)
+      {
+        numbers[&I] = numbers.size();
+      }
+    }
+
+    for (Argument &Arg : F.args())
+    {
+      encodeType(OS, Arg.getType(), structs);
+      OS << Arg.getName() << '\0';
+    }
+
+    for (BasicBlock &BB : F)
+    {
+      OS << "\nb";
+
+      for (Instruction &I : BB)
+      {
+        OS << '\n' << I.getOpcode() << ' ';
+        encodeType(OS, I.getType(), structs);
+        OS << I.getName() << '\0';
+
+        if (AllocaInst *AI = dyn_cast<AllocaInst>(&I))
+        {
+          encodeType(OS, AI->getAllocatedType(), structs);
+        }
+        else if (GetElementPtrInst *GEP = dyn_cast<GetElementPtrInst>(&I))
+        {
+          encodeType(OS, GEP->getSourceElementType(), structs);
+        }
+
+        for (Value *operand : I.operands())
+        {
+          encodeOperand(OS, operand, numbers, structs);
+        }
+      }
+    }
+
+    return xxHash64(buffer);
+  }
+
+  // Encodes the type, then the bodies of the identified structs in it which have not been encoded yet, since the type only names them
+  static void encodeType(raw_ostream &OS, Type *T, SmallPtrSetImpl<StructType *> &structs)
+  {
+    T->print(OS, false, true);
+    OS << '\0';
+
+    encodeStructBodies(OS, T, structs);
+  }
+
+  static void encodeStructBodies(raw_ostream &OS, Type *T, SmallPtrSetImpl<StructType *> &structs)
+  {
+    StructType *ST = dyn_cast<StructType>(T);
+
+    if (ST && !ST->isLiteral())
+    {
+      if (!structs.insert(ST).second)
+      {
+        return;
+      }
+
+      ST->print(OS, false, false);
+      OS << '\0';
+    }
+
+    for (Type *subtype : T->subtypes())
+    {
+      encodeStructBodies(OS, subtype, structs);
+    }
+  }
+
+  static void encodeOperand(raw_ostream &OS, Value *V, const DenseMap<const Value *, unsigned> &numbers, SmallPtrSetImpl<StructType *> &structs)
+  {
+    auto it = numbers.find(V);
+
+    if (it != numbers.end())
+    {
+      OS << '%' << it->second;
+    }
+    else if (GlobalValue *GV = dyn_cast<GlobalValue>(V))
+    {
+      OS << '@' << GV->getName() << '\0';
+    }
+    else if (ConstantInt *CI = dyn_cast<ConstantInt>(V))
+    {
+      OS << 'i' << CI->getValue();
+    }
+    else if (Constant *C = dyn_cast<Constant>(V))
+    {
+      OS << 'c' << (unsigned)C->getValueID() << '(';
+      encodeType(OS, C->getType(), structs);
+
+      if (ConstantExpr *CE = dyn_cast<ConstantExpr>(C))
+      {
+        OS << CE->getOpcode();
+      }
+
+      for (Value *operand : C->operands())
+      {
+        encodeOperand(OS, operand, numbers, structs);
+      }
+
+      OS << ')';
+    }
+    else  // Metadata and inline assembly, which the analysis ignores
+    {
+      OS << '?';
+    }
+  }
+
+  static void writeString(support::endian::Writer &writer, StringRef s)
+  {
+    writer.write<uint32_t>(s.size());
+    writer.OS << s;
+  }
+
+  static bool readInt(StringRef &data, uint32_t &value)
+  {
+    if (data.size() < 4)
+    {
+      return false;
+    }
+
+    value = support::endian::read32le(data.data());
+    data = data.drop_front(4);
+
+    return true;
+  }
+
+  static bool readString(StringRef &data, StringRef &s)
+  {
+    uint32_t size;
+
+    if (!readInt(data, size) || data.size() < size)
+    {
+      return false;
+    }
+
+    s = data.take_front(size);
+    data = data.drop_front(size);
+
+    return true;
+  }
+};
+
+// The work of all the analyses run by the passes, for -alias-print-work
+fixpoint_counters total_counters;
+std::mutex total_counters_lock;
+
+// Adds the work done by an analysis to the statistics and the totals
+void recordCounters(const fixpoint_counters &counters)
+{
+  std::lock_guard<std::mutex> guard(total_counters_lock);
+
+  NumWorklistPops += counters.worklist_pops;
+  NumTransfers += counters.transfers;
+  NumMeets += counters.meets;
+  NumLatticeSize += counters.lattice_size;
+
+  total_counters += counters;
+}
+
+// Prints the work done by the pass for -alias-print-work, as {"pass": ..., "worklist_iterations": ..., ...}
+void printWork(StringRef pass_name)
+{
+  if (!AliasPrintWork)
+  {
+    return;
+  }
+
+  json::OStream J(errs());
+
+  J.object([&] {
+    J.attribute("pass", pass_name);
+    J.attribute("worklist_iterations", (int64_t)total_counters.worklist_pops);
+    J.attribute("transfers", (int64_t)total_counters.transfers);
+    J.attribute("meets", (int64_t)total_counters.meets);
+    J.attribute("lattice_size", (int64_t)total_counters.lattice_size);
+  });
+
+  errs() << "\n";
+}
+
+// Returns the alias map of the function, from the cache or else by running the analysis selected by -alias-mode, and sets the tier which produced it
+alias_map_t getAliasMap(Function &F, fixpoint_trace &trace, alias_mode &tier)
+{
+  alias_map_t alias_map;
+  fixpoint_counters counters;
+  function_timer timer(trace, "alias_lib", F, counters);
+
+  if (alias_result_cache::lookup(F, alias_map, tier))
+  {
+    return alias_map;
+  }
+
+  points_to_analysis analysis;
+  bool timed_out;
+
+  tier = analyzeFunction(F, analysis, timed_out);
+
+  counters = analysis.getCounters();
+  recordCounters(counters);
+
+  alias_result_cache::store(F, analysis.getAliasMap(), tier, timed_out);
+
+  return analysis.getAliasMap();
+}
+
+struct alias_c : public FunctionPass {
+  static char ID;
+  alias_c() : FunctionPass(ID) {}
+
+  std::unique_ptr<alias_report> report;
+  std::unique_ptr<fixpoint_trace> trace;
+
+  bool doInitialization(Module &M) override
+  {
+    report.reset(new alias_report(M));
+    trace.reset(new fixpoint_trace(AliasTrace));
+
+    return false;
+  }
+
+  bool doFinalization(Module &) override
+  {
+    report.reset();
+    trace->write();
+    printWork("alias_lib_given");
+
+    return false;
+  }
+
+  bool runOnFunction(Function &F) override {
+    // The -fno-discard-value-names flag has been used while using clang to generate the LLVM IR files (to preserve the variable names)
+
+    alias_mode tier;
+    alias_map_t alias_map = getAliasMap(F, *trace, tier);
+
+    report->print(F, alias_map, tier);
+
+    return false;
+  }
+}; // end of struct alias_c
+
+// Interprocedural may-alias analysis
+// Functions are analyzed bottom-up over the strongly connected components of the call graph, and calls are modelled using the summaries of the called functions
+struct alias_ipa_c : public ModulePass {
+  static char ID;
+  alias_ipa_c() : ModulePass(ID) {}
+
+  std::map<Function *, function_summary> summaries;
+  std::map<Function *, alias_map_t> alias_maps;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override
+  {
+    AU.addRequired<CallGraphWrapperPass>();
+    AU.setPreservesAll();
+  }
+
+  // Runs the flow-sensitive analysis of the function, recording its time and counters
+  void analyze(Function &F, points_to_analysis &analysis, fixpoint_trace &trace)
+  {
+    fixpoint_counters counters;
+    function_timer timer(trace, "alias_lib", F, counters);
+
+    analysis.run(F);
+
+    counters = analysis.getCounters();
+    recordCounters(counters);
+  }
+
+  // Replaces the summary of the function by one that assumes the return value and every parameter's object may point to anything reachable from the parameters
+  void widenSummary(Function &F)
+  {
+    function_summary &summary = summaries[&F];
+    summary_set everything;
+
+    for (Argument &Arg : F.args())
+    {
+      if (Arg.getType()->isPointerTy())
+      {
+        everything.params.insert(Arg.getArgNo());
+      }
+    }
+
+    everything.merge(summary.ret);
+
+    for (auto &pair : summary.pointees)
+    {
+      everything.merge(pair.second);
+    }
+
+    summary.ret = everything;
+
+    for (unsigned param : everything.params)
+    {
+      summary.pointees[param] = everything;
+    }
+  }
+
+  bool runOnModule(Module &M) override {
+    CallGraph &CG = getAnalysis<CallGraphWrapperPass>().getCallGraph();
+    std::vector<Function *> scc_functions;
+    fixpoint_trace trace(AliasTrace);
+    function_summary old_summary;
+    unsigned round;
+    bool changed;
+
+    for (scc_iterator<CallGraph *> SCC = scc_begin(&CG); !SCC.isAtEnd(); ++SCC)  // Visiting the SCCs bottom-up
+    {
+      scc_functions.clear();
+
+      for (CallGraphNode *node : *SCC)
+      {
+        if (node->getFunction() && !node->getFunction()->isDeclaration())
+        {
+          scc_functions.push_back(node->getFunction());
+        }
+      }
+
+      // Each function of a recursive SCC is analyzed until the summaries of the SCC stop changing, at most MaxSCCRounds times
+
+      for (Function *F : scc_functions) // Calls within the SCC are modelled by the (initially empty) summaries from the start
+      {
+        summaries[F];
+      }
+
+      changed = true;
+
+      for (round = 0; changed && round < std::max(1u, (unsigned)MaxSCCRounds); round++)
+      {
+        changed = false;
+
+        for (Function *F : scc_functions)
+        {
+          points_to_analysis analysis(&summaries);
+
+          analyze(*F, analysis, trace);
+
+          old_summary = summaries[F];
+          summaries[F].merge(analysis.getSummary(*F));
+          alias_maps[F] = analysis.getAliasMap();
+
+          if (SCC.hasCycle() && !(summaries[F] == old_summary))
+          {
+            changed = true;
+          }
+        }
+      }
+
+      if (changed)  // The round limit was reached, so the summaries of the SCC are made conservative and the functions are analyzed once more
+      {
+        for (Function *F : scc_functions)
+        {
+          widenSummary(*F);
+        }
+
+        for (Function *F : scc_functions)
+        {
+          points_to_analysis analysis(&summaries);
+
+          analyze(*F, analysis, trace);
+
+          alias_maps[F] = analysis.getAliasMap();
+        }
+      }
+    }
+
+    alias_report report(M);
+
+    for (Function &F : M)  // Printing the output in module order
+    {
+      if (!F.isDeclaration())
+      {
+        report.print(F, alias_maps[&F], FLOW_SENSITIVE);
+      }
+    }
+
+    trace.write();
+    printWork("alias_lib_ipa");
+
+    return false;
+  }
+}; // end of struct alias_ipa_c
+
+// Runs the analysis of alias_c on all the functions of the module concurrently, and prints the results in module order
+// The analysis of a function only reads that function and the data layout, so the output is the same as that of alias_lib_given
+// The data layout computes the layouts of struct types lazily, into an unlocked map, so they are all computed before the threads start
+// The functions are not timed under -time-passes, whose timers are not thread-safe; -alias-trace records their times per thread instead
+struct alias_parallel_c : public ModulePass {
+  static char ID;
+  alias_parallel_c() : ModulePass(ID) {}
+
+  bool runOnModule(Module &M) override {
+    std::vector<Function *> functions;
+
+    for (Function &F : M)
+    {
+      if (!F.isDeclaration())
+      {
+        functions.push_back(&F);
+      }
+    }
+
+    std::vector<alias_map_t> alias_maps(functions.size());
+    std::vector<alias_mode> tiers(functions.size());
+    fixpoint_trace trace(AliasTrace, true);
+
+    computeStructLayouts(M);
+
+    work_stealing_pool pool(AliasThreads ? AliasThreads : std::thread::hardware_concurrency());
+
+    pool.run(functions.size(),
+             [&](int i) { alias_maps[i] = getAliasMap(*functions[i], trace, tiers[i]); },
+             [&](int i) { return (uint64_t)functions[i]->getInstructionCount(); });
+
+    alias_report report(M);
+
+    for (unsigned i = 0; i < functions.size(); i++)
+    {
+      report.print(*functions[i], alias_maps[i], tiers[i]);
+    }
+
+    trace.write();
+    printWork("alias_lib_parallel");
+
+    return false;
+  }
+
+  // Computes the layouts of all the struct types used by the module, which the splitting of allocas into fields and the offsets of getelementptrs query
+  static void computeStructLayouts(Module &M)
+  {
+    const DataLayout &DL = M.getDataLayout();
+    TypeFinder types;
+
+    types.run(M, false);
+
+    for (StructType *ST : types)
+    {
+      if (ST->isSized())
+      {
+        DL.getStructLayout(ST);
+      }
+    }
+  }
+}; // end of struct alias_parallel_c
+
+// The state behind alias_aa_result, kept at a fixed address so that its value handles can refer back to it
+// The instructions of the function are tracked, so that deleting or replacing one marks the state stale; the next query then updates the points-to maps
+// incrementally (re-propagating only from the basic blocks which changed) instead of recomputing them
+class alias_aa_state
+{
+public:
+  explicit alias_aa_state(Function &F) : F(F), escaping(false), stale(true)
+  {
+    refresh();
+  }
+
+  // Marks the state as out of date after the function has been changed
+  void markStale()
+  {
+    stale = true;
+  }
+
+  AliasResult alias(const Value *A, const Value *B)
+  {
+    SmallPtrSet<const Value *, 4> objects_a, objects_b;
+
+    checkInserted(A);
+    checkInserted(B);
+    refresh();
+
+    auto key = A < B ? std::make_pair(A, B) : std::make_pair(B, A);
+    auto it = alias_cache.find(key);
+
+    if (it != alias_cache.end())
+    {
+      return it->second;
+    }
+
+    AliasResult result = AliasResult::MayAlias;
+
+    if (getObjects(A, objects_a) && getObjects(B, objects_b) && !objects_a.empty() && !objects_b.empty())
+    {
+      result = AliasResult::NoAlias;
+
+      for (const Value *object : objects_a)
+      {
+        if (objects_b.count(object))
+        {
+          result = AliasResult::MayAlias;
+          break;
+        }
+      }
+    }
+
+    track(A);
+    track(B);
+    alias_cache.insert(std::make_pair(key, result));
+
+    return result;
+  }
+
+  // Checks if the accesses touch disjoint bytes of the allocas, using the fields which loaded pointers point into
+  bool areDisjoint(const MemoryLocation &LocA, const MemoryLocation &LocB)
+  {
+    SmallVector<points_to_analysis::byte_range, 4> ranges_a, ranges_b;
+
+    if (!getAccessedBytes(LocA, ranges_a) || !getAccessedBytes(LocB, ranges_b))
+    {
+      return false;
+    }
+
+    for (const points_to_analysis::byte_range &a : ranges_a)
+    {
+      for (const points_to_analysis::byte_range &b : ranges_b)
+      {
+        if (a.object == b.object && a.begin < b.end && b.begin < a.end)
+        {
+          return false;
+        }
+      }
+    }
+
+    return true;
+  }
+
+  ModRefInfo getModRefInfo(const CallBase *Call, const Value *Ptr)
+  {
+    SmallPtrSet<const Value *, 4> objects, arg_objects;
+
+    checkInserted(Call);
+    checkInserted(Ptr);
+    refresh();
+
+    auto key = std::make_pair(Call, Ptr);
+
+    auto it = mod_ref_cache.find(key);
+
+    if (it != mod_ref_cache.end())
+    {
+      return it->second;
+    }
+
+    ModRefInfo result = ModRefInfo::NoModRef;
+
+    if (!getObjects(Ptr, objects) || objects.empty())
+    {
+      result = ModRefInfo::ModRef;
+    }
+
+    for (const Value *object : objects)
+    {
+      if (escaped.count(object))
+      {
+        result = ModRefInfo::ModRef;
+      }
+    }
+
+    for (const Use &Arg : Call->args())  // Calls which are not escapes (such as lifetime markers) may still access the objects passed to them
+    {
+      getStructuralObjects(Arg.get(), arg_objects);
+    }
+
+    for (const Value *object : objects)
+    {
+      if (arg_objects.count(object))
+      {
+        result = ModRefInfo::ModRef;
+      }
+    }
+
+    track(Call);
+    track(Ptr);
+    mod_ref_cache.insert(std::make_pair(key, result));
+
+    return result;
+  }
+
+private:
+  // Marks the state stale when a value that it mentions is deleted or replaced, and forgets deleted values since their addresses could be reused by new values
+  struct value_handle : public CallbackVH
+  {
+    alias_aa_state *state;
+
+    value_handle(const Value *V, alias_aa_state *state) : CallbackVH(const_cast<Value *>(V)), state(state) {}
+
+    void deleted() override
+    {
+      state->forget(getValPtr());
+      setValPtr(nullptr);
+    }
+
+    void allUsesReplacedWith(Value *) override
+    {
+      state->invalidate();
+      state->markStale();
+    }
+  };
+
+  Function &F;
+  points_to_analysis analysis;  // Kept between updates, so that they only re-propagate from the changed basic blocks
+  bool escaping;  // Whether the address of any alloca may be accessed outside the function or through untracked pointers
+  bool stale; // Whether the function has changed since the points-to maps were last updated
+  SmallPtrSet<const Value *, 16> escaped, stored; // Allocas which calls may access, and allocas whose addresses are stored
+  DenseMap<const Value *, SmallVector<const Value *, 4>> load_objects;  // Pointer load -> allocas which it may point into
+  DenseMap<const Value *, SmallVector<points_to_analysis::byte_range, 4>> load_ranges;  // Pointer load -> bytes of the allocas which it may point into
+  DenseMap<std::pair<const Value *, const Value *>, AliasResult> alias_cache;
+  DenseMap<std::pair<const CallBase *, const Value *>, ModRefInfo> mod_ref_cache;
+  SmallPtrSet<const Value *, 16> tracked;
+  std::deque<value_handle> handles;
+
+  void track(const Value *V)
+  {
+    if (!isa<Constant>(V) && tracked.insert(V).second)
+    {
+      handles.emplace_back(V, this);
+    }
+  }
+
+  void invalidate()
+  {
+    alias_cache.clear();
+    mod_ref_cache.clear();
+  }
+
+  // Drops everything recorded about a deleted value
+  void forget(const Value *V)
+  {
+    load_objects.erase(V);
+    load_ranges.erase(V);
+    escaped.erase(V);
+    stored.erase(V);
+    tracked.erase(V);
+    invalidate();
+    stale = true;
+  }
+
+  // Marks the state stale if the queried value is an instruction inserted into the function since the last update
+  void checkInserted(const Value *V)
+  {
+    const Instruction *I = dyn_cast<Instruction>(V);
+
+    if (I && I->getFunction() == &F && !tracked.count(I))
+    {
+      stale = true;
+    }
+  }
+
+  // Brings the points-to maps up to date with the function if it has changed, and recomputes the loaded pointers and escapes from them
+  void refresh()
+  {
+    if (!stale)
+    {
+      return;
+    }
+
+    analysis.update(F);
+
+    stale = false;
+    escaping = false;
+    escaped.clear();
+    stored.clear();
+    load_objects.clear();
+    load_ranges.clear();
+    invalidate();
+
+    resolveLoads(analysis);
+    calculateEscapes();
+
+    for (Instruction &I : instructions(F))
+    {
+      track(&I);
+    }
+
+    for (const Value *object : escaped)
+    {
+      track(object);
+    }
+  }
+
+  // Returns the pointer which the value is derived from through casts and getelementptr instructions
+  static const Value *getBase(const Value *V)
+  {
+    V = V->stripPointerCasts();
+
+    while (const GEPOperator *GEP = dyn_cast<GEPOperator>(V))
+    {
+      V = GEP->getPointerOperand()->stripPointerCasts();
+    }
+
+    return V;
+  }
+
+  // Adds the allocas of the function which the value points into, by following casts and getelementptr instructions
+  // Returns false if the value is not derived from an alloca in this way
+  bool getStructuralObjects(const Value *V, SmallPtrSetImpl<const Value *> &objects)
+  {
+    V = getBase(V);
+
+    const AllocaInst *AI = dyn_cast<AllocaInst>(V);
+
+    if (!AI || AI->getFunction() != &F)
+    {
+      return false;
+    }
+
+    objects.insert(AI);
+
+    return true;
+  }
+
+  // Adds the allocas of the function which the value may point into, using the points-to maps for loaded pointers
+  // Returns false if they are not known
+  bool getObjects(const Value *V, SmallPtrSetImpl<const Value *> &objects)
+  {
+    V = getBase(V);
+
+    auto it = load_objects.find(V);
+
+    if (it != load_objects.end())
+    {
+      objects.insert(it->second.begin(), it->second.end());
+
+      return true;
+    }
+
+    return getStructuralObjects(V, objects);
+  }
+
+  // Adds the bytes of the allocas which the access may touch: from a constant offset into an alloca, or from a constant offset to a loaded pointer
+  // Returns false if they are not known
+  bool getAccessedBytes(const MemoryLocation &Loc, SmallVectorImpl<points_to_analysis::byte_range> &ranges)
+  {
+    const DataLayout &DL = F.getParent()->getDataLayout();
+    APInt offset(DL.getIndexTypeSizeInBits(Loc.Ptr->getType()), 0);
+    const Value *base = Loc.Ptr->stripAndAccumulateConstantOffsets(DL, offset, true);
+    uint64_t size = Loc.Size.hasValue() ? Loc.Size.getValue() : UINT64_MAX;
+
+    if (offset.isNegative())
+    {
+      return false;
+    }
+
+    auto it = load_ranges.find(base);
+
+    if (it != load_ranges.end())
+    {
+      for (const points_to_analysis::byte_range &range : it->second) // The loaded pointer may point to any byte in the range
+      {
+        ranges.push_back({range.object, SaturatingAdd(range.begin, offset.getZExtValue()),
+                          SaturatingAdd(SaturatingAdd(range.end - 1, offset.getZExtValue()), size)});
+      }
+
+      return true;
+    }
+
+    const AllocaInst *AI = dyn_cast<AllocaInst>(base);
+
+    if (!AI || AI->getFunction() != &F)
+    {
+      return false;
+    }
+
+    ranges.push_back({AI, offset.getZExtValue(), SaturatingAdd(offset.getZExtValue(), size)});
+
+    return true;
+  }
+
+  // Checks if the value is the address of a pointer variable or of a struct or array holding pointers, i.e. one of the cells which the points-to maps describe
+  bool isCell(const Value *V)
+  {
+    SmallPtrSet<const Value *, 4> objects;
+
+    if (!getObjects(V, objects) || objects.empty())
+    {
+      return false;
+    }
+
+    for (const Value *object : objects)
+    {
+      if (!points_to_analysis::isCell(*cast<AllocaInst>(object)))
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  // Records the allocas which each pointer loaded from a pointer variable may point into
+  void resolveLoads(points_to_analysis &analysis)
+  {
+    SmallVector<points_to_analysis::byte_range, 4> pointees;
+    SmallPtrSet<const Value *, 4> objects;
+    bool resolved;
+
+    for (Instruction &I : instructions(F)) // Loads through loaded pointers come after the loads they depend on in -O0 code
+    {
+      LoadInst *LI = dyn_cast<LoadInst>(&I);
+
+      if (!LI || !LI->getType()->isPointerTy() || !isCell(LI->getPointerOperand()))
+      {
+        continue;
+      }
+
+      pointees.clear();
+      objects.clear();
+
+      resolved = analysis.getPointeeRanges(LI, pointees) && !pointees.empty();
+
+      for (const points_to_analysis::byte_range &pointee : pointees)
+      {
+        resolved = resolved && getStructuralObjects(pointee.object, objects);
+      }
+
+      if (resolved)
+      {
+        load_objects[LI].assign(objects.begin(), objects.end());
+        load_ranges[LI].assign(pointees.begin(), pointees.end());
+        track(LI);
+      }
+    }
+  }
 
-  // Checks if the given variable has a name or not
-  bool hasName(std::string s)
+  // Checks if the use may let the address in its operand be accessed other than through the pointer variables which the points-to maps describe
+  bool isEscapingUse(const Use &U)
   {
-    if (s[0] == '%' || s.compare(0, 10, "arraydecay") == 0)
+    const Instruction *I = cast<Instruction>(U.getUser());
+
+    if (!U->getType()->isPointerTy() || isa<LoadInst>(I) || isa<GetElementPtrInst>(I) || isa<BitCastInst>(I) || isa<ICmpInst>(I))
     {
       return false;
     }
 
+    if (const StoreInst *SI = dyn_cast<StoreInst>(I))
+    {
+      return U.getOperandNo() == 0 && !isCell(SI->getPointerOperand());
+    }
+
+    if (const IntrinsicInst *II = dyn_cast<IntrinsicInst>(I))
+    {
+      return !II->isLifetimeStartOrEnd() && !isa<DbgInfoIntrinsic>(II);
+    }
+
     return true;
   }
 
-  bool runOnFunction(Function &F) override {
-    // The -fno-discard-value-names flag has been used while using clang to generate the LLVM IR files (to preserve the variable names)
-    // It is assumed that the opt tool is run from the llvm-project/build/ folder
+  // Finds the allocas whose addresses may be used outside the function or through pointers which are not tracked
+  void calculateEscapes()
+  {
+    SmallPtrSet<const Value *, 16> escaping_objects;
+
+    for (Instruction &I : instructions(F))
+    {
+      for (const Use &U : I.operands())
+      {
+        if (isEscapingUse(U))
+        {
+          // A loaded pointer which is not resolved may hold any address stored in the function
 
-    int num_instructions = 0, i, flag, instruction_number, prev_instruction_number, j, next_instruction_number;
+          escaping = escaping || (!getObjects(U.get(), escaping_objects) && isa<LoadInst>(getBase(U.get()))) || !escaping_objects.empty();
+          getStructuralObjects(U.get(), escaped);
+        }
 
-    std::vector<std::pair<std::string, std::set<std::string>>> initial_points_to_map, alias_map;
+        if (isa<StoreInst>(I) && U.getOperandNo() == 0 && U->getType()->isPointerTy())  // Once anything escapes, every stored address may be read by a call
+        {
+          getStructuralObjects(U.get(), stored);
+        }
+      }
+    }
 
-    std::string instruction_statement, local_identifier, ptr1, ptr2, input_filepath, output_filename, pointer_name;
+    // The points-to maps do not describe memory which escaped addresses allow others to modify, so loaded pointers are then no longer resolved
 
-    Instruction *prev_instruction;
+    if (escaping)
+    {
+      load_objects.clear();
+      load_ranges.clear();
+      escaped.insert(stored.begin(), stored.end());
+    }
+    else
+    {
+      escaped.clear();
+    }
+  }
+};
+// The results of the flow-sensitive analysis, exposed through LLVM's alias analysis interface
+// A pointer is resolved to the allocas it may point into: directly for addresses of allocas, and through the points-to maps for pointers loaded from pointer variables
+// Pointers resolving to disjoint allocas do not alias, and calls cannot access allocas whose addresses never escape
+class alias_aa_result : public AAResultBase<alias_aa_result>
+{
+public:
+  explicit alias_aa_result(Function &F) : state(new alias_aa_state(F)) {}
 
-    BasicBlock *successor;
+  // Keeps the result when the function changes, as it brings itself up to date on the next query
+  bool invalidate(Function &, const PreservedAnalyses &PA, FunctionAnalysisManager::Invalidator &)
+  {
+    if (!PA.areAllPreserved())
+    {
+      state->markStale();
+    }
 
-    std::set<std::string> intersect;
+    return false;
+  }
 
-    std::ofstream output_file;
+  void markStale()
+  {
+    state->markStale();
+  }
 
-    const std::string output_directory_path = "../assignment-3-may-alias-analysis-ArchitGanvir/output/";
+  AliasResult alias(const MemoryLocation &LocA, const MemoryLocation &LocB, AAQueryInfo &)
+  {
+    AliasResult result = state->alias(LocA.Ptr, LocB.Ptr);
 
-    for (BasicBlock &BB : F)  // Counting the number of instructions in the function
+    if (result == AliasResult::MayAlias && state->areDisjoint(LocA, LocB))
     {
-      num_instructions += BB.size();
+      return AliasResult::NoAlias;
     }
 
-    bool worklist[num_instructions];
+    return result;
+  }
+
+  ModRefInfo getModRefInfo(const CallBase *Call, const MemoryLocation &Loc, AAQueryInfo &)
+  {
+    return state->getModRefInfo(Call, Loc.Ptr);
+  }
+
+  using AAResultBase::getModRefInfo;
+
+private:
+  std::unique_ptr<alias_aa_state> state;
+};
 
-    std::vector<std::pair<std::string, std::set<std::string>>> out[num_instructions], new_out[num_instructions];
+// Adds alias_aa_result to the alias analyses of the legacy pass manager, e.g. opt -load alias_lib.so -alias_lib_aa -aa-eval
+struct alias_aa_wrapper_pass : public ExternalAAWrapperPass {
+  static char ID;
+
+  // The result of each function is kept while the alias analyses are rebuilt after changes to it, so that it can be updated rather than recomputed
+  DenseMap<Function *, std::unique_ptr<alias_aa_result>> results;
 
-    // Calculating the initial values for the points-to maps and initializing alias_map
+  alias_aa_wrapper_pass() : ExternalAAWrapperPass([this](Pass &, Function &F, AAResults &AAR) {
+    std::unique_ptr<alias_aa_result> &result = results[&F];
 
-    for (auto &B : F) // Getting the pointers from the instruction statements
+    if (result)
     {
-      for (auto &I : B)
-      {
-        if (AllocaInst *AI = dyn_cast<AllocaInst>(&I))
-        {
-          if (AI->getAllocatedType()->isPointerTy()) // Variables assigned in alloca instructions are always named
-          {
-            initial_points_to_map.push_back(std::make_pair(std::string(AI->getName()), std::set<std::string>{}));
-            alias_map.push_back(std::make_pair(std::string(AI->getName()), std::set<std::string>{}));
-          }
-          else if (AI->getAllocatedType()->isArrayTy())
-          {
-            initial_points_to_map.push_back(std::make_pair(std::string(AI->getName()), std::set<std::string>{std::string(AI->getName()) + "[0]"}));
-            alias_map.push_back(std::make_pair(std::string(AI->getName()), std::set<std::string>{}));
-          }
-        }
-        else if (LoadInst *LI = dyn_cast<LoadInst>(&I))
-        {
-          if (LI->getType()->isPointerTy()) // Variables assigned in load instructions are always unnamed
-          {
-            std::string s;  // Getting the instruction statement as a string
-            raw_string_ostream rso(s);
-            rso << I;
-            instruction_statement = rso.str();
+      result->markStale();
+    }
+    else
+    {
+      result.reset(new alias_aa_result(F));
+    }
 
-            local_identifier = instruction_statement.substr(instruction_statement.find("%"), instruction_statement.find(" ", instruction_statement.find("%")) - instruction_statement.find("%"));  // Getting the local identifier which is being assigned
+    AAR.addAAResult(*result);
+  }) {}
+}; // end of struct alias_aa_wrapper_pass
 
-            initial_points_to_map.push_back(std::make_pair(local_identifier, std::set<std::string>{}));
-          }
-        }
-        else if (GetElementPtrInst *GEP = dyn_cast<GetElementPtrInst>(&I))  // Variables assigned in getelementptr instructions are treated as unnamed
-        {
-          initial_points_to_map.push_back(std::make_pair(std::string(GEP->getName()), std::set<std::string>{}));
-        }
+// alias_aa_result as an analysis of the new pass manager, e.g. opt -load-pass-plugin alias_lib.so -aa-pipeline=default,alias-lib-aa -passes=aa-eval
+class alias_lib_aa : public AnalysisInfoMixin<alias_lib_aa>
+{
+  friend AnalysisInfoMixin<alias_lib_aa>;
+
+  static AnalysisKey Key;
+
+public:
+  typedef alias_aa_result Result;
+
+  Result run(Function &F, FunctionAnalysisManager &)
+  {
+    return alias_aa_result(F);
+  }
+};
+
+AnalysisKey alias_lib_aa::Key;
+
+// How far the address of an alloca may travel: only through the pointer variables of the function, into calls which do not capture it, or anywhere
+enum escape_kind
+{
+  NO_ESCAPE,
+  ARG_ESCAPE,
+  GLOBAL_ESCAPE
+};
+
+// The escape analysis of the allocas of a function, computed on top of the flow-sensitive points-to maps
+// Addresses held in pointer variables are followed through the loads which read them, so storing an address into a local pointer variable is not an escape;
+// an alloca escapes at least as far as any pointer variable holding its address
+class alias_escape_result
+{
+public:
+  explicit alias_escape_result(Function &F) : F(&F)
+  {
+    points_to_analysis analysis;
+
+    analysis.run(F);
+
+    calculateEscapes(analysis);
+  }
+
+  // Returns how far the address of the alloca may escape
+  escape_kind getEscape(const AllocaInst *AI) const
+  {
+    auto it = escapes.find(AI);
+
+    return it == escapes.end() ? GLOBAL_ESCAPE : it->second;
+  }
+
+  // Checks if the address of the alloca never leaves the pointer variables of the function, so that it can be promoted or split
+  bool isNoEscape(const AllocaInst *AI) const
+  {
+    return getEscape(AI) == NO_ESCAPE;
+  }
+
+  // Checks if the alloca does not outlive the function, even though calls may access it while they run
+  bool isCapturedLocally(const AllocaInst *AI) const
+  {
+    return getEscape(AI) != GLOBAL_ESCAPE;
+  }
+
+  void print(raw_ostream &OS) const
+  {
+    static const char *const names[] = {"no-escape", "arg-escape", "global-escape"};
+
+    OS << "Escapes of function " << F->getName() << ":\n";
+
+    for (Instruction &I : instructions(*F))
+    {
+      if (AllocaInst *AI = dyn_cast<AllocaInst>(&I))
+      {
+        OS << "  ";
+        AI->printAsOperand(OS, false);
+        OS << ": " << names[getEscape(AI)] << "\n";
       }
     }
+  }
+
+private:
+  Function *F;
+  DenseMap<const AllocaInst *, escape_kind> escapes;
+
+  // Adds the allocas of the function which the value may point into, following casts, getelementptrs, phis and selects, and using the points-to maps for
+  // loaded pointers; values which cannot hold the address of a non-escaping alloca (arguments, globals, call results) add nothing
+  // Returns false if the value is a load whose points-to set is not known
+  bool getObjects(points_to_analysis &analysis, const Value *V, SmallPtrSetImpl<const Value *> &objects, SmallPtrSetImpl<const Value *> &visited)
+  {
+    SmallVector<const Value *, 4> pointees;
+
+    V = V->stripPointerCasts();
+
+    if (!visited.insert(V).second)
+    {
+      return true;
+    }
 
-    for (i = 0; i < num_instructions; i++)  // Initializing the worklist and OUT maps
+    if (const GEPOperator *GEP = dyn_cast<GEPOperator>(V))
     {
-      worklist[i] = true;  // Adding all the instructions to the worklist
+      return getObjects(analysis, GEP->getPointerOperand(), objects, visited);
+    }
+
+    if (const AllocaInst *AI = dyn_cast<AllocaInst>(V))
+    {
+      objects.insert(AI);
 
-      out[i] = initial_points_to_map;
+      return true;
     }
 
-    while (1) // Performing the may-alias analysis
+    if (isa<PHINode>(V) || isa<SelectInst>(V))
     {
-      for (i = 0; i < num_instructions; i++)  // Checking if the worklist is empty
+      bool known = true;
+
+      for (const Value *operand : cast<Instruction>(V)->operands())
       {
-        if (worklist[i] == true)
+        if (operand->getType()->isPointerTy())
         {
-          break;
+          known = getObjects(analysis, operand, objects, visited) && known;
         }
       }
 
-      if (i == num_instructions)
+      return known;
+    }
+
+    if (!isa<LoadInst>(V))
+    {
+      return true;
+    }
+
+    if (!analysis.getPointees(V, pointees))
+    {
+      return false;
+    }
+
+    for (const Value *pointee : pointees)
+    {
+      if (isa<AllocaInst>(pointee))
       {
-        break;
+        objects.insert(pointee);
       }
-      
-      worklist[i] = false;  // Removing the instruction from the worklist
+    }
+
+    return true;
+  }
 
-      instruction_number = 0;
+  // Returns how far the use lets the address in its operand escape, taking the pointer variables which a store writes into as the holders of the address
+  escape_kind getUseEscape(points_to_analysis &analysis, const Use &U, SmallPtrSetImpl<const Value *> &holders)
+  {
+    const Instruction *I = cast<Instruction>(U.getUser());
+    SmallPtrSet<const Value *, 4> visited;
+
+    if (isa<LoadInst>(I) || isa<GetElementPtrInst>(I) || isa<CastInst>(I) || isa<ICmpInst>(I) || isa<PHINode>(I) || isa<SelectInst>(I))
+    {
+      return isa<PtrToIntInst>(I) ? GLOBAL_ESCAPE : NO_ESCAPE;  // Derived pointers are followed from their own uses
+    }
+
+    if (const StoreInst *SI = dyn_cast<StoreInst>(I))
+    {
+      if (U.getOperandNo() != 0)
+      {
+        return NO_ESCAPE;
+      }
 
-      new_out[i] = initial_points_to_map; // Initializing the new OUT map
+      if (!getObjects(analysis, SI->getPointerOperand(), holders, visited) || holders.empty())
+      {
+        return GLOBAL_ESCAPE;
+      }
 
-      flag = 0; // For checking if the instruction has been found
-      for (BasicBlock &BB : F)
+      for (const Value *holder : holders)
       {
-        for (Instruction &I : BB)
+        if (!points_to_analysis::isCell(*cast<AllocaInst>(holder)))  // The points-to maps only follow addresses stored into their cells
         {
-          if (i == instruction_number)
-          {
-            flag = 1; // The instruction has been found
+          return GLOBAL_ESCAPE;
+        }
+      }
 
-            prev_instruction = I.getPrevNode();
+      return NO_ESCAPE;
+    }
 
-            // Calculating the IN map
+    if (const IntrinsicInst *II = dyn_cast<IntrinsicInst>(I))
+    {
+      if (II->isLifetimeStartOrEnd() || isa<DbgInfoIntrinsic>(II))
+      {
+        return NO_ESCAPE;
+      }
+    }
 
-            if (prev_instruction != NULL) // Checking if the instruction is not the first instruction in its basic block
-            {
-              prev_instruction_number = i - 1;
+    if (const CallBase *Call = dyn_cast<CallBase>(I))
+    {
+      if (Call->isArgOperand(&U) && Call->doesNotCapture(Call->getArgOperandNo(&U)))
+      {
+        return ARG_ESCAPE;
+      }
+    }
 
-              new_out[i] = out[prev_instruction_number]; // Copying the OUT map of the previous instruction into the new OUT map
-            }
-            else
-            {
-              prev_instruction_number = -1; // For finding the last instruction of a predecessor basic block
-              for (BasicBlock &BB_ : F)
-              {
-                prev_instruction_number += BB_.size();
-
-                for (j = 0; j < BB_.getTerminator()->getNumSuccessors(); j++)
-                {
-                  if (BB_.getTerminator()->getSuccessor(j) == &BB)  // Checking if BB_is a predecessor of BB
-                  {
-                    // Assigning the union of the new OUT map and the OUT map of BB_ to the new OUT map
-
-                    for (auto &pair : new_out[i])
-                    {
-                      for (auto &other_pair : out[prev_instruction_number])
-                      {
-                        if (pair.first == other_pair.first)
-                        {
-                          pair.second.insert(other_pair.second.begin(), other_pair.second.end());
-
-                          break;
-                        }
-                      }
-                    }
-                  }
-                }
-              }
-            }
+    return GLOBAL_ESCAPE;
+  }
 
-            std::string s;  // Getting the instruction statement as a string
-            raw_string_ostream rso(s);
-            rso << I;
-            instruction_statement = rso.str();
+  // Raises the escape of the object, and of the objects whose addresses it may hold, to at least the given kind
+  void raise(const Value *object, escape_kind kind, const DenseMap<const Value *, SmallPtrSet<const Value *, 4>> &held)
+  {
+    SmallVector<const Value *, 8> worklist(1, object);
 
-            // Calculating the new OUT map
+    while (!worklist.empty())
+    {
+      const AllocaInst *AI = cast<AllocaInst>(worklist.pop_back_val());
+      escape_kind &escape = escapes[AI];
 
-            if (LoadInst *LI = dyn_cast<LoadInst>(&I))
-            {
-              if (LI->getType()->isPointerTy())
-              {
-                ptr1 = instruction_statement.substr(instruction_statement.find("%"), instruction_statement.find(" ", instruction_statement.find("%")) - instruction_statement.find("%"));  // Getting the local identifier which is being assigned
-
-                ptr2 = std::string(LI->getOperand(0)->getName());  // Getting the pointer operand
-
-                if (ptr2.empty())
-                {
-                  ptr2 = instruction_statement.substr(instruction_statement.find_last_of('%'), instruction_statement.find_last_of(',') - instruction_statement.find_last_of('%'));
-                }
-
-                if (hasName(ptr2))
-                {
-                  for (auto &pair : new_out[i])
-                  {
-                    if (pair.first == ptr1)
-                    {
-                      for (auto &other_pair : new_out[i])
-                      {
-                        if (other_pair.first == ptr2)
-                        {
-                          pair.second = other_pair.second;
-
-                          break;
-                        }
-                      }
-
-                      break;
-                    }
-                  }
-                }
-                else
-                {
-                  for (auto &pair : new_out[i])
-                  {
-                    if (pair.first == ptr1)
-                    {
-                      pair.second.clear();
-
-                      for (auto &other_pair : new_out[i])
-                      {
-                        if (other_pair.first == ptr2)
-                        {
-                          for (auto &ptr : other_pair.second)
-                          {
-                            for (auto &another_pair : new_out[i])
-                            {
-                              if (another_pair.first == ptr)
-                              {
-                                pair.second.insert(another_pair.second.begin(), another_pair.second.end());
-
-                                break;
-                              }
-                            }
-                          }
-
-                          break;
-                        }
-                      }
-
-                      break;
-                    }
-                  }
-                }
-              } 
-            }
-            else if (StoreInst *SI = dyn_cast<StoreInst>(&I))
-            {
-              if (SI->getOperand(0)->getType()->isPointerTy())
-              {
-                ptr1 = std::string(SI->getOperand(0)->getName());  // Getting the value operand
-
-                if (ptr1.empty()) // Checking if the value operand is unnamed
-                {
-                  ptr1 = instruction_statement.substr(instruction_statement.find('%'), instruction_statement.find(',') - instruction_statement.find('%')); // Getting the value operand from the instruction statement
-                }
-                
-                ptr2 = std::string(SI->getOperand(1)->getName());  // Getting the pointer operand
-
-                if (ptr2.empty()) // Checking if the pointer operand is unnamed
-                {
-                  ptr2 = instruction_statement.substr(instruction_statement.find_last_of('%'), instruction_statement.find_last_of(',') - instruction_statement.find_last_of('%')); // Getting the pointer operand from the instruction statement
-                }
-
-                if (hasName(ptr1) && hasName(ptr2))
-                {
-                  for (auto &pair : new_out[i])
-                  {
-                    if (pair.first == ptr2)
-                    {
-                      pair.second.clear();
-  
-                      pair.second.insert(ptr1);
-  
-                      break;
-                    }
-                  }
-                }
-                else if (hasName(ptr1))
-                {
-                  for (auto &pair : new_out[i])
-                  {
-                    if (pair.first == ptr2)
-                    {
-                      if (pair.second.size() == 1)
-                      {
-                        for (auto &other_pair : new_out[i])
-                        {
-                          if (other_pair.first == *pair.second.begin())
-                          {
-                            other_pair.second.clear();
-
-                            other_pair.second.insert(ptr1);
-
-                            break;
-                          }
-                        }
-                      }
-                      else
-                      {
-                        for (auto &ptr : pair.second)
-                        {
-                          for (auto &other_pair : new_out[i])
-                          {
-                            if (other_pair.first == ptr)
-                            {
-                              other_pair.second.insert(ptr1);
-
-                              break;
-                            }
-                          }
-                        }
-                      }
-
-                      break;
-                    }
-                  }
-                }
-                else if (hasName(ptr2))
-                {
-                  for (auto &pair : new_out[i])
-                  {
-                    if (pair.first == ptr2)
-                    {
-                      for (auto &other_pair : new_out[i])
-                      {
-                        if (other_pair.first == ptr1)
-                        {
-                          pair.second = other_pair.second;
-
-                          break;
-                        }
-                      }
-
-                      break;
-                    }
-                  }
-                }
-                else
-                {
-                  for (auto &pair : new_out[i])
-                  {
-                    if (pair.first == ptr2)
-                    {
-                      if (pair.second.size() == 1)
-                      {
-                        for (auto &other_pair : new_out[i])
-                        {
-                          if (other_pair.first == *pair.second.begin())
-                          {
-                            other_pair.second.clear();
-
-                            for (auto &another_pair : new_out[i])
-                            {
-                              if (another_pair.first == ptr1)
-                              {
-                                other_pair.second = another_pair.second;
-
-                                break;
-                              }
-                            }
-
-                            break;
-                          }
-                        }
-                      }
-                      else
-                      {
-                        for (auto &ptr : pair.second)
-                        {
-                          for (auto &other_pair : new_out[i])
-                          {
-                            if (other_pair.first == ptr)
-                            {
-                              for (auto &another_pair : new_out[i])
-                              {
-                                if (another_pair.first == ptr1)
-                                {
-                                  other_pair.second.insert(another_pair.second.begin(), another_pair.second.end());
-
-                                  break;
-                                }
-                              }
-
-                              break;
-                            }
-                          }
-                        }
-                      }
-
-                      break;
-                    }
-                  }
-                }
-              }
-            }
-            else if (GetElementPtrInst *GEP = dyn_cast<GetElementPtrInst>(&I))
-            {
-              ptr1 = std::string(GEP->getName());
+      if (escape >= kind)
+      {
+        continue;
+      }
 
-              ptr2 = std::string(GEP->getPointerOperand()->getName());
+      escape = kind;
 
-              for (auto &pair : new_out[i])
-              {
-                if (pair.first == ptr1)
-                {
-                  for (auto &other_pair : new_out[i])
-                  {
-                    if (other_pair.first == ptr2)
-                    {
-                      pair.second = other_pair.second;
-
-                      break;
-                    }
-                  }
-                  
-                  break;
-                }
-              }
-            }
+      auto it = held.find(AI);
 
-            if (out[i] == new_out[i]) // Checking if the old OUT map is equal to the new OUT map
-            {
-              break;
-            }
+      if (it != held.end())
+      {
+        worklist.append(it->second.begin(), it->second.end());
+      }
+    }
+  }
+
+  // Classifies every alloca of the function by the furthest-reaching use of any pointer which may hold its address
+  void calculateEscapes(points_to_analysis &analysis)
+  {
+    DenseMap<const Value *, SmallPtrSet<const Value *, 4>> held;  // Pointer variable -> allocas whose addresses may be stored into it
+    SmallPtrSet<const Value *, 16> stored;  // Allocas whose addresses are stored into pointer variables
+    SmallPtrSet<const Value *, 16> copied;  // Allocas whose contents are copied by memcpy or memmove
+    std::vector<std::pair<std::vector<const Value *>, escape_kind>> uses;  // Escaping uses, with the allocas whose addresses they may let escape
+    std::vector<const Value *> copied_addresses;
+    bool unknown_escape = false;  // Whether a pointer loaded with an unknown points-to set escapes
+    bool unknown_copied = false;  // Whether memcpy or memmove copies from a pointer with an unknown points-to set
+    escape_kind unknown_kind = NO_ESCAPE;
 
-            out[i] = new_out[i]; // Copying the new OUT map into the old OUT map
+    for (Instruction &I : instructions(*F))
+    {
+      if (AllocaInst *AI = dyn_cast<AllocaInst>(&I))
+      {
+        escapes[AI] = NO_ESCAPE;
+      }
+    }
 
-            // Adding all the successors of the instruction to the worklist
+    for (Instruction &I : instructions(*F))
+    {
+      for (const Use &U : I.operands())
+      {
+        SmallPtrSet<const Value *, 4> objects, holders, visited;
 
-            if (I.getNextNode() != NULL) // Checking if the instruction is not the last instruction in its basic block
-            {
-              worklist[i + 1] = true; // Adding the next instruction to the worklist
-            }
-            else
-            {
-              for (j = 0; j < I.getNumSuccessors(); j++)  // Adding the first instruction of all successor basic blocks to the worklist
-              {
-                successor = I.getSuccessor(j);
-                next_instruction_number = 0; // For finding the instruction number of the first instruction of the successor basic block
-                for (BasicBlock &BB : F)  // Iterating through all the basic blocks to find the successor basic block
-                {
-                  if (&BB == successor) // Checking if the basic block is a successor basic block
-                  {
-                    worklist[next_instruction_number] = true;  // Adding the first instruction of the successor basic block to the worklist
-
-                    break;
-                  }
-
-                  next_instruction_number += BB.size();  // Counting the number of instructions that come before the first instruction of the successor basic block
-                }
-              } 
-            }
+        if (!U->getType()->isPointerTy())
+        {
+          continue;
+        }
 
-            break;
-          }
+        escape_kind kind = getUseEscape(analysis, U, holders);
+        bool known = getObjects(analysis, U.get(), objects, visited);
 
-          instruction_number++;
+        if (objects.empty() && known)
+        {
+          continue;
         }
 
-        if (flag == 1)  // Checking if the instruction had been found
+        if (isa<MemTransferInst>(I) && &U == &cast<MemTransferInst>(I).getRawSourceUse())
         {
-          break;
+          unknown_copied |= !known;
+          copied.insert(objects.begin(), objects.end());
         }
-      }
-    }
 
-    // Calculating alias_map
+        if (!known && kind != NO_ESCAPE)
+        {
+          unknown_escape = true;
+          unknown_kind = std::max(unknown_kind, kind);
+        }
 
-    for (i = num_instructions - 1; i < num_instructions; i++)  // Checking the OUT map of each instruction
-    {
-      for (auto &pair : out[i])
-      {
-        if (hasName(pair.first))
+        if (kind != NO_ESCAPE)
         {
-          for (auto &other_pair : out[i])
+          uses.emplace_back(std::vector<const Value *>(objects.begin(), objects.end()), kind);
+        }
+        else if (isa<StoreInst>(I))
+        {
+          for (const Value *holder : holders)
           {
-            if (hasName(other_pair.first) && pair.first != other_pair.first)
-            {
-              flag = 0; // For checking if the pair is already present in alias_map
-              for (auto &alias_pair : alias_map)
-              {
-                if (alias_pair.first == pair.first)
-                {
-                  if (alias_pair.second.find(other_pair.first) != alias_pair.second.end())
-                  {
-                    flag = 1; // The pair is already present in alias_map
-
-                    break;
-                  }
-                }
-              }
-
-              if (flag == 0)  // If the pair is not already present in alias_map
-              {
-                intersect.clear();
-
-                set_intersection(pair.second.begin(), pair.second.end(), other_pair.second.begin(), other_pair.second.end(), std::inserter(intersect, intersect.begin()));
-
-                if (!intersect.empty())
-                {
-                  for (auto &alias_pair : alias_map)
-                  {
-                    if (alias_pair.first == pair.first)
-                    {
-                      alias_pair.second.insert(other_pair.first);
-                    }
-                  }
-                }
-              }
-            }
+            held[holder].insert(objects.begin(), objects.end());
           }
+
+          stored.insert(objects.begin(), objects.end());
         }
       }
     }
 
-    input_filepath = std::string(F.getParent()->getName()); // Getting the path to the input file
+    // A loaded pointer whose points-to set is not known may hold any address stored into a pointer variable
 
-    output_filename = input_filepath.substr(input_filepath.find_last_of('/') + 1, input_filepath.find_last_of('.') - input_filepath.find_last_of('/') - 1) + ".txt";  // Getting the name of the output file
-
-    if (F.getName() == F.getParent()->begin()->getName()) // Checking if the function is the first function in the module
+    if (unknown_escape)
     {
-      output_file.open(output_directory_path + output_filename);  // Creating a new file or overwriting the existing file
+      uses.emplace_back(std::vector<const Value *>(stored.begin(), stored.end()), unknown_kind);
     }
-    else
+
+    // The points-to maps do not follow the pointers which memcpy and memmove copy, so the addresses held by their sources may end up anywhere
+
+    for (const Value *object : copied)
     {
-      output_file.open(output_directory_path + output_filename, std::ios_base::app);  // Appending to the existing file
+      auto it = held.find(object);
+
+      if (it != held.end())
+      {
+        copied_addresses.insert(copied_addresses.end(), it->second.begin(), it->second.end());
+      }
     }
 
-    // Printing the output
+    if (unknown_copied)
+    {
+      copied_addresses.insert(copied_addresses.end(), stored.begin(), stored.end());
+    }
 
-    output_file << std::string(F.getName()) << "\n"; // Printing the function name
-    errs() << std::string(F.getName()) << "\n";
+    uses.emplace_back(copied_addresses, GLOBAL_ESCAPE);
 
-    for (auto &pair : alias_map)
+    for (auto &use : uses)
     {
-      pointer_name = pair.first;
+      for (const Value *object : use.first)
+      {
+        raise(object, use.second, held);
+      }
+    }
+  }
+};
 
-      pointer_name = pointer_name.substr(0, pointer_name.find_last_of('.'));  // Removing the .addr from the pointer name
+// Prints the escape analysis of each function for the legacy pass manager, e.g. opt -load alias_lib.so -alias_lib_escape -analyze
+struct alias_escape_wrapper_pass : public FunctionPass {
+  static char ID;
 
-      output_file << pointer_name << " -> {";
-      errs() << pointer_name << " -> {";
+  std::unique_ptr<alias_escape_result> result;
 
-      if (!pair.second.empty())
-      {
-        for (auto alias = pair.second.begin(); alias != --pair.second.end(); alias++)
-        {
-          pointer_name = *alias;
+  alias_escape_wrapper_pass() : FunctionPass(ID) {}
+
+  bool runOnFunction(Function &F) override
+  {
+    result.reset(new alias_escape_result(F));
 
-          pointer_name = pointer_name.substr(0, pointer_name.find_last_of('.'));  // Removing the .addr from the pointer name
+    return false;
+  }
 
-          output_file << pointer_name << ", ";
-          errs() << pointer_name << ", ";
-        }
+  void print(raw_ostream &OS, const Module *) const override
+  {
+    if (result)
+    {
+      result->print(OS);
+    }
+  }
 
-        pointer_name = *pair.second.rbegin();
+  void getAnalysisUsage(AnalysisUsage &AU) const override
+  {
+    AU.setPreservesAll();
+  }
+}; // end of struct alias_escape_wrapper_pass
 
-        pointer_name = pointer_name.substr(0, pointer_name.find_last_of('.'));  // Removing the .addr from the pointer name
+// alias_escape_result as an analysis of the new pass manager, for transformations such as scalar replacement and heap-to-stack rewriting to query
+class alias_lib_escape : public AnalysisInfoMixin<alias_lib_escape>
+{
+  friend AnalysisInfoMixin<alias_lib_escape>;
 
-        output_file << pointer_name;
-        errs() << pointer_name;
-      }
+  static AnalysisKey Key;
 
-      output_file << "}\n";
-      errs() << "}\n";
-    }
+public:
+  typedef alias_escape_result Result;
 
-    output_file.close();
+  Result run(Function &F, FunctionAnalysisManager &)
+  {
+    return alias_escape_result(F);
+  }
+};
 
-    return false;
+AnalysisKey alias_lib_escape::Key;
+
+// Prints alias_lib_escape, e.g. opt -load-pass-plugin alias_lib.so -passes='print<alias-lib-escape>'
+class alias_escape_printer : public PassInfoMixin<alias_escape_printer>
+{
+public:
+  PreservedAnalyses run(Function &F, FunctionAnalysisManager &FAM)
+  {
+    FAM.getResult<alias_lib_escape>(F).print(errs());
+
+    return PreservedAnalyses::all();
   }
-}; // end of struct alias_c
+};
 }  // end of anonymous namespace
 
 char alias_c::ID = 0;
 static RegisterPass<alias_c> X("alias_lib_given", "Alias Analysis Pass for Assignment",
                              false /* Only looks at CFG */,
                              false /* Analysis Pass */);
+
+char alias_ipa_c::ID = 0;
+static RegisterPass<alias_ipa_c> Y("alias_lib_ipa", "Interprocedural Alias Analysis Pass",
+                                   false /* Only looks at CFG */,
+                                   false /* Analysis Pass */);
+
+char alias_parallel_c::ID = 0;
+static RegisterPass<alias_parallel_c> Z("alias_lib_parallel", "Multi-threaded Alias Analysis Pass",
+                                        false /* Only looks at CFG */,
+                                        false /* Analysis Pass */);
+
+char alias_aa_wrapper_pass::ID = 0;
+static RegisterPass<alias_aa_wrapper_pass> W("alias_lib_aa", "Alias Analysis Results of alias_lib_given",
+                                             false /* Only looks at CFG */,
+                                             true /* Analysis Pass */);
+
+char alias_escape_wrapper_pass::ID = 0;
+static RegisterPass<alias_escape_wrapper_pass> E("alias_lib_escape", "Escape Analysis on the Results of alias_lib_given",
+                                                 false /* Only looks at CFG */,
+                                                 true /* Analysis Pass */);
+
+extern "C" LLVM_ATTRIBUTE_WEAK ::llvm::PassPluginLibraryInfo llvmGetPassPluginInfo()
+{
+  return {LLVM_PLUGIN_API_VERSION, "alias_lib", "v0.1", [](PassBuilder &PB) {
+            PB.registerAnalysisRegistrationCallback([](FunctionAnalysisManager &FAM) {
+              FAM.registerPass([] { return alias_lib_aa(); });
+              FAM.registerPass([] { return alias_lib_escape(); });
+            });
+
+            PB.registerPipelineParsingCallback([](StringRef Name, FunctionPassManager &FPM, ArrayRef<PassBuilder::PipelineElement>) {
+              if (Name == "print<alias-lib-escape>")
+              {
+                FPM.addPass(alias_escape_printer());
+                return true;
+              }
+
+              return false;
+            });
+
+            PB.registerParseAACallback([](StringRef Name, AAManager &AAM) {
+              if (Name == "alias-lib-aa")
+              {
+                AAM.registerFunctionAnalysis<alias_lib_aa>();
+                return true;
+              }
+
+              return false;
+            });
+          }};
+}